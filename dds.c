@@ -0,0 +1,134 @@
+//*****************************************************************************
+// Title        : Pulse to tone (DTMF) converter
+// Author       : Boris Cherkasskiy
+//                http://boris0.blogspot.ca/2013/09/rotary-dial-for-digital-age.html
+// Created      : 2011-10-24
+//
+// Modified     : Arnie Weber 2015-06-22
+//                https://bitbucket.org/310weber/rotary_dial/
+//                NOTE: This code is not compatible with Boris's original hardware
+//                due to changed pin-out (see Eagle files for details)
+//
+// Modified     : Matthew Millman 2018-05-29
+//                http://tech.mattmillman.com/
+//                Cleaned up implementation, modified to work more like the
+//                Rotatone product.
+//
+// This code is distributed under the GNU Public License
+// which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+// DTMF generator logic is loosely based on the AVR314 app note from Atmel
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <util/atomic.h>
+
+#include "dds.h"
+
+//************************** SIN TABLE *************************************
+// Samples table : one period sampled on NUM_SAMPLES samples and
+// quantized on DDS_SIN_BITS bit (7 bit for 8 bit PWM, 8 with DDS_NOISE_SHAPE):
+// entry = ROUND((2^(bits-1) - 0.5) * (1 + sin(2 * pi * i / NUM_SAMPLES)))
+// GCC folds the sin() calls, nothing is computed at run time. The small
+// bias keeps entries that land exactly on .5 (i = 0, NUM_SAMPLES / 2)
+// from depending on the compiler's floating point precision.
+//**************************************************************************
+#define SIN_HALF_RANGE          ((1 << (DDS_SIN_BITS - 1)) - 0.5)
+#define SIN_PI                  3.14159265358979323846
+#define SIN_1(i)                (uint8_t)(SIN_HALF_RANGE * (1.0 + __builtin_sin(2.0 * SIN_PI * (i) / NUM_SAMPLES)) + 0.5001)
+#define SIN_4(i)                SIN_1(i), SIN_1((i) + 1), SIN_1((i) + 2), SIN_1((i) + 3)
+#define SIN_16(i)               SIN_4(i), SIN_4((i) + 4), SIN_4((i) + 8), SIN_4((i) + 12)
+#define SIN_64(i)               SIN_16(i), SIN_16((i) + 16), SIN_16((i) + 32), SIN_16((i) + 48)
+
+#ifdef DDS_QUARTER_WAVE
+
+// First quadrant only, including the peak (see dds_lookup)
+const uint8_t auc_sin_param[DDS_TABLE_SIZE] PROGMEM = {
+#if NUM_SAMPLES == 64
+    SIN_16(0),
+#elif NUM_SAMPLES == 128
+    SIN_16(0), SIN_16(16),
+#elif NUM_SAMPLES >= 256
+    SIN_64(0),
+#endif
+#if NUM_SAMPLES == 512
+    SIN_64(64),
+#endif
+    SIN_1(NUM_SAMPLES / 4)
+};
+
+#else
+
+const uint8_t auc_sin_param[DDS_TABLE_SIZE] PROGMEM = {
+    SIN_64(0),
+#if NUM_SAMPLES >= 128
+    SIN_64(64),
+#endif
+#if NUM_SAMPLES >= 256
+    SIN_64(128), SIN_64(192),
+#endif
+#if NUM_SAMPLES >= 512
+    SIN_64(256), SIN_64(320), SIN_64(384), SIN_64(448),
+#endif
+};
+
+#endif /* DDS_QUARTER_WAVE */
+
+volatile uint16_t _g_stepwidth_a;               // step width of high frequency
+volatile uint16_t _g_stepwidth_b;               // step width of low frequency
+volatile uint16_t _g_cur_sin_val_a;             // position freq. A in LUT (extended format)
+volatile uint16_t _g_cur_sin_val_b;             // position freq. B in LUT (extended format)
+
+#ifdef DDS_NOISE_SHAPE
+volatile uint8_t _g_ns_error;                   // part of the last mix the PWM couldn't take
+#endif
+
+#ifdef DDS_BUFFERED
+volatile uint8_t _g_sample_buf[DDS_BUF_SIZE];   // samples waiting for the ISR
+volatile uint8_t _g_sample_head;                // next slot dds_fill() writes
+volatile uint8_t _g_sample_tail;                // next slot the ISR reads
+#endif
+
+void dds_init(void)
+{
+    _g_stepwidth_a = 0x00;
+    _g_stepwidth_b = 0x00;
+
+    _g_cur_sin_val_a = DDS_PHASE_BIAS;
+    _g_cur_sin_val_b = DDS_PHASE_BIAS;
+
+#ifdef DDS_NOISE_SHAPE
+    _g_ns_error = 0;
+#endif
+
+#ifdef DDS_BUFFERED
+    _g_sample_head = 0;
+    _g_sample_tail = 0;
+#endif
+}
+
+#ifdef DDS_BUFFERED
+// Top up the sample ring. Only the ISR moves the tail and only this moves
+// the head; both are single bytes, so no locking is needed
+void dds_fill(void)
+{
+    uint8_t head = _g_sample_head;
+    uint8_t next;
+
+    while ((next = (head + 1) & (DDS_BUF_SIZE - 1)) != _g_sample_tail)
+    {
+        _g_sample_buf[head] = dds_next_sample();
+        _g_sample_head = head = next;
+    }
+}
+
+// Drop samples not played yet, the ISR then holds the last one
+void dds_flush(void)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        _g_sample_head = _g_sample_tail;
+    }
+}
+#endif
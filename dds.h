@@ -0,0 +1,200 @@
+//*****************************************************************************
+// Title        : Pulse to tone (DTMF) converter
+// Author       : Boris Cherkasskiy
+//                http://boris0.blogspot.ca/2013/09/rotary-dial-for-digital-age.html
+// Created      : 2011-10-24
+//
+// Modified     : Arnie Weber 2015-06-22
+//                https://bitbucket.org/310weber/rotary_dial/
+//                NOTE: This code is not compatible with Boris's original hardware
+//                due to changed pin-out (see Eagle files for details)
+//
+// Modified     : Matthew Millman 2018-05-29
+//                http://tech.mattmillman.com/
+//                Cleaned up implementation, modified to work more like the
+//                Rotatone product.
+//
+// This code is distributed under the GNU Public License
+// which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+// DTMF generator logic is loosely based on the AVR314 app note from Atmel
+//
+//*****************************************************************************
+
+#ifndef __DDS_H__
+#define __DDS_H__
+
+// Hardware independent part of the tone generator. Everything in here
+// must compile both with avr-gcc and with the host compiler (see host/)
+
+// Table length, PWM resolution and F_CPU may be changed from the Makefile;
+// the sine and step tables in dds.c are generated from them at compile time.
+
+#ifndef NUM_SAMPLES
+#define NUM_SAMPLES                 128     // Number of samples in lookup table
+#endif
+
+#define DDS_PWM_BITS                8       // Timer0 fast PWM, TOP = 0xFF
+
+// -DDDS_NOISE_SHAPE keeps DDS_NS_BITS more than the PWM takes through the
+// mix and feeds the part that is cut off into the next sample (first order
+// error feedback). The requantization noise is then shaped by 1 - z^-1:
+// lower in the DTMF band, higher towards half the sample rate where the RC
+// filter takes it out. The table also gains its spare bit, as the mix is
+// scaled down afterwards instead of relying on 7 bit entries.
+#ifdef DDS_NOISE_SHAPE
+#define DDS_SIN_BITS                DDS_PWM_BITS
+#define DDS_NS_BITS                 3
+#else
+#define DDS_SIN_BITS                (DDS_PWM_BITS - 1)
+#endif
+
+// Phase accumulators are 16 bit with the table index in the top bits.
+// Accumulators start half a sample in so the index rounds to nearest.
+#if NUM_SAMPLES == 64
+#define DDS_INDEX_SHIFT             10
+#elif NUM_SAMPLES == 128
+#define DDS_INDEX_SHIFT             9
+#elif NUM_SAMPLES == 256
+#define DDS_INDEX_SHIFT             8
+#elif NUM_SAMPLES == 512
+#define DDS_INDEX_SHIFT             7
+#else
+#error "NUM_SAMPLES must be 64, 128, 256 or 512"
+#endif
+
+#define DDS_PHASE_BIAS              (1 << (DDS_INDEX_SHIFT - 1))
+
+// PWM frequency, i.e. the sample rate
+#define DDS_SAMPLE_RATE             (F_CPU >> DDS_PWM_BITS)
+
+// Scale an "excess 8" step width (x_SW, see dds.c) to the accumulator
+#define DDS_STEP(x_sw)              ((uint16_t)(x_sw) << (DDS_INDEX_SHIFT - 3))
+
+// x_SW for a frequency in Hz at the current F_CPU (folded at compile time)
+#define DDS_XSW(f)                  ((uint16_t)(8.0 * NUM_SAMPLES * (f) / DDS_SAMPLE_RATE + 0.5))
+
+// Step width for a frequency in Hz. By default every bit of the accumulator
+// is used (F_CPU / 2^24 resolution, 0.24Hz at 4MHz, within 0.02% of every
+// DTMF frequency). -DDDS_EXCESS8 restores the AVR314 "excess 8" steps,
+// which are only accurate to about 1%.
+#ifdef DDS_EXCESS8
+#define DDS_FREQ(f)                 DDS_STEP(DDS_XSW(f))
+#else
+#define DDS_FREQ(f)                 ((uint16_t)(65536.0 * (f) / DDS_SAMPLE_RATE + 0.5))
+#endif
+
+#if DDS_SAMPLE_RATE < 2 * 2 * 1633
+#warning "Sample rate too low for DTMF: tone images fall inside the voice band"
+#endif
+
+// -DDDS_QUARTER_WAVE stores only the first quadrant (NUM_SAMPLES / 4 + 1
+// entries) and folds the index: about a quarter of the memory for the same
+// resolution, or a 512 entry table for the size of a 128 entry one
+#ifdef DDS_QUARTER_WAVE
+#define DDS_TABLE_SIZE              (NUM_SAMPLES / 4 + 1)
+#else
+#define DDS_TABLE_SIZE              NUM_SAMPLES
+#endif
+
+// -DDDS_BUFFERED moves sample generation out of the Timer0 ISR: the main
+// loop fills a ring of DDS_BUF_SIZE samples (dds_fill) while it waits and
+// the ISR only copies the next one to OCR0A. Must be a power of two, one
+// slot is always left free.
+#ifndef DDS_BUF_SIZE
+#define DDS_BUF_SIZE                16
+#endif
+
+#if DDS_BUF_SIZE & (DDS_BUF_SIZE - 1)
+#error "DDS_BUF_SIZE must be a power of two"
+#endif
+
+#ifndef __ASSEMBLER__
+
+#include <stdint.h>
+#include <avr/pgmspace.h>
+
+// In flash: a full table of 256 or 512 entries would take half or all of
+// the ATtiny85's SRAM
+extern const uint8_t auc_sin_param[DDS_TABLE_SIZE] PROGMEM;
+
+extern volatile uint16_t _g_stepwidth_a;
+extern volatile uint16_t _g_stepwidth_b;
+extern volatile uint16_t _g_cur_sin_val_a;
+extern volatile uint16_t _g_cur_sin_val_b;
+
+#ifdef DDS_NOISE_SHAPE
+extern volatile uint8_t _g_ns_error;
+#endif
+
+#ifdef DDS_BUFFERED
+extern volatile uint8_t _g_sample_buf[DDS_BUF_SIZE];
+extern volatile uint8_t _g_sample_head;
+extern volatile uint8_t _g_sample_tail;
+#endif
+
+void dds_init(void);
+
+// Sine table entry for a phase accumulator value
+static inline uint8_t dds_lookup(uint16_t phase)
+{
+#ifdef DDS_QUARTER_WAVE
+    uint8_t index = (phase >> DDS_INDEX_SHIFT) & (NUM_SAMPLES / 4 - 1);
+    uint8_t sample;
+
+    // Second and fourth quadrants run backwards through the table
+    if (phase & 0x4000)
+        index = NUM_SAMPLES / 4 - index;
+
+    sample = pgm_read_byte(&auc_sin_param[index]);
+
+    // Second half is the first one mirrored about the mid point
+    if (phase & 0x8000)
+        sample = ((1 << DDS_SIN_BITS) - 1) - sample;
+
+    return sample;
+#else
+    return pgm_read_byte(&auc_sin_param[phase >> DDS_INDEX_SHIFT]);
+#endif
+}
+
+// Advance both oscillators by one sample and return the next PWM value.
+// dtmf_isr.S implements the same thing by hand; keep them in step.
+static inline uint8_t dds_next_sample(void)
+{
+    uint8_t sin_a;
+    uint8_t sin_b = 0;
+
+    // A component (high frequency) is always used
+    _g_cur_sin_val_a += _g_stepwidth_a;
+    sin_a = dds_lookup(_g_cur_sin_val_a);
+
+    // B component (low frequency) is optional
+    if (_g_stepwidth_b)
+    {
+        _g_cur_sin_val_b += _g_stepwidth_b;
+        sin_b = dds_lookup(_g_cur_sin_val_b);
+    }
+
+#ifdef DDS_NOISE_SHAPE
+    // 4 * high frequency value + 3 * low frequency value is the usual mix
+    // with DDS_NS_BITS to spare: the error left from the last sample goes
+    // back in before cutting them off
+    uint16_t mix = ((uint16_t)sin_a << 2) + sin_b + ((uint16_t)sin_b << 1) + _g_ns_error;
+
+    _g_ns_error = mix & ((1 << DDS_NS_BITS) - 1);
+    return mix >> DDS_NS_BITS;
+#else
+    // calculate PWM value: high frequency value + 3/4 low frequency value
+    return (sin_a + (sin_b - (sin_b >> 2)));
+#endif
+}
+
+#ifdef DDS_BUFFERED
+void dds_fill(void);
+void dds_flush(void);
+#endif
+
+#endif /* __ASSEMBLER__ */
+
+#endif /* __DDS_H__ */
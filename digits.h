@@ -0,0 +1,53 @@
+//*****************************************************************************
+// Title        : Packed digit strings
+// Author       : agent
+// Created      : 2026-10-16
+//
+// Part of the pulse to tone (DTMF) converter.
+//
+// This code is distributed under the GNU Public License
+// which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+#ifndef __DIGITS_H__
+#define __DIGITS_H__
+
+// Stored numbers are packed two digits to a byte, low nibble first. A
+// nibble holds 0-9, DIGIT_STAR or DIGIT_POUND; 0xF (erased EEPROM) ends the
+// number. 32 digits fit in 16 bytes.
+
+#include <stdint.h>
+
+#include "dtmf.h"
+
+#define DIGITS_MAX                  32
+#define DIGITS_PACKED_SIZE          (DIGITS_MAX / 2)
+#define DIGITS_PACKED_EMPTY         0xFF    // Two terminators
+#define DIGITS_NIBBLE_END           0x0F
+
+// Digit i of a packed number, DIGIT_OFF at and after the end
+static inline int8_t digits_get(const uint8_t *packed, uint8_t i)
+{
+    uint8_t nibble = packed[i >> 1];
+
+    if (i & 1)
+        nibble >>= 4;
+
+    nibble &= 0x0F;
+
+    return nibble <= DIGIT_POUND ? (int8_t)nibble : DIGIT_OFF;
+}
+
+// Store digit i (DIGIT_OFF stores the terminator)
+static inline void digits_set(uint8_t *packed, uint8_t i, int8_t digit)
+{
+    uint8_t nibble = (digit >= 0 && digit <= DIGIT_POUND) ? (uint8_t)digit : DIGITS_NIBBLE_END;
+
+    if (i & 1)
+        packed[i >> 1] = (packed[i >> 1] & 0x0F) | (nibble << 4);
+    else
+        packed[i >> 1] = (packed[i >> 1] & 0xF0) | nibble;
+}
+
+#endif /* __DIGITS_H__ */
@@ -24,61 +24,56 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <avr/interrupt.h>
-#include <avr/sleep.h>
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
+#include <util/delay.h>
 
+#include "dds.h"
+#include "digits.h"
 #include "dtmf.h"
+#include "timer.h"
+#include "trace.h"
 
-#define TIMER_CLK_DIV1              0x01    ///< Timer clocked at F_CPU
-#define TIMER_PRESCALE_MASK0        0x07    ///< Timer Prescaler Bit-Mask
-#define NUM_SAMPLES                 128     // Number of samples in lookup table
+#define SLEEP_MS_CHUNK              1000    // Longest wait one 16 bit deadline covers
+#define QUEUED_NUMBER               -2      // Queue entry that plays _g_number
 
+// Register the Timer0 ISR writes every sample to, and the value for it
+#ifdef DTMF_PLL_PWM
+#define PWM_OCR                     OCR1A
+#define PWM_VALUE(sample)           ((uint8_t)~(sample))    // the pin is !OC1A
+#define PLL_LOCK_US                 100
+#else
+#define PWM_OCR                     OCR0A
+#define PWM_VALUE(sample)           (sample)
+#endif
 
-static void dtmf_enable_pwm(void);
+typedef struct
+{
+    int8_t digit;
+    uint8_t duration;                       // DTMF_QUEUE_UNIT_MS units
+    uint8_t gap;                            // DTMF_QUEUE_UNIT_MS units
+} dtmf_queued_tone_t;
 
-//************************** SIN TABLE *************************************
-// Samples table : one period sampled on 128 samples and
-// quantized on 7 bit
-//**************************************************************************
-const uint8_t auc_sin_param[NUM_SAMPLES] = {
-    64,  67,  70,  73,
-    76,  79,  82,  85,
-    88,  91,  94,  96,
-    99,  102, 104, 106,
-    109, 111, 113, 115,
-    117, 118, 120, 121,
-    123, 124, 125, 126,
-    126, 127, 127, 127,
-    127, 127, 127, 127,
-    126, 126, 125, 124,
-    123, 121, 120, 118,
-    117, 115, 113, 111,
-    109, 106, 104, 102,
-    99,  96,  94,  91,
-    88,  85,  82,  79,
-    76,  73,  70,  67,
-    64,  60,  57,  54,
-    51,  48,  45,  42,
-    39,  36,  33,  31,
-    28,  25,  23,  21,
-    18,  16,  14,  12,
-    10,  9,   7,   6,
-    4,   3,   2,   1,
-    1,   0,   0,   0,
-    0,   0,   0,   0,
-    1,   1,   2,   3,
-    4,   6,   7,   9,
-    10,  12,  14,  16,
-    18,  21,  23,  25,
-    28,  31,  33,  36,
-    39,  42,  45,  48,
-    51,  54,  57,  60
-};
+static void dtmf_enable_pwm(void);
+static void dtmf_disable_pwm(void);
+static void dtmf_output_on(void);
+static void dtmf_output_off(void);
+static void dtmf_set_steps(uint16_t step_a, uint16_t step_b);
+static void dtmf_set_ticks(uint16_t ticks);
+static bool dtmf_delay_pending(void);
+static void dtmf_advance(void);
+static bool dtmf_next_digit(void);
+static void dtmf_start_sound(const dtmf_queued_tone_t *tone);
+static void dtmf_play_note(void);
 
 //***************************  x_SW  ***************************************
-// Fck = Xtal/prescaler
-// Table of x_SW (excess 8): x_SW = ROUND(8 * N_samples * f * 510 / Fck)
+// Fck = F_CPU, PWM period = 256 clocks
+// Table of x_SW (excess 8): x_SW = ROUND(8 * N_samples * f * 256 / Fck)
+// Only used with DDS_EXCESS8, otherwise the step is ROUND(65536 * f * 256 / Fck)
+// (see DDS_FREQ in dds.h)
 //**************************************************************************
 
+// Excess 8 at 4MHz:
 // high frequency
 // 1209hz  ---> x_SW = 79
 // 1336hz  ---> x_SW = 87
@@ -97,165 +92,427 @@ const uint8_t auc_sin_param[NUM_SAMPLES] = {
 //  852 |   7  |  8   |   9  |   C
 //  941 |   *  |  0   |   #  |   D
 
-const uint8_t auc_frequency[12][2] =
+// Note table entries: frequencies in Hz, length and gap in DTMF_NOTE_WHOLE
+// parts of the queued duration
+#define NOTE(high, low, len, gap)   { DDS_FREQ(high), DDS_FREQ(low), (len), (gap) }
+#define NOTE_1(high, len, gap)      { DDS_FREQ(high), 0, (len), (gap) }
+#define WHOLE                       DTMF_NOTE_WHOLE
+#define LAST                        DTMF_NOTE_LAST
+
+const dtmf_note_t _g_notes[] PROGMEM =
 {
-    { 87, 61 }, // 0
-    { 79, 46 }, // 1
-    { 87, 46 }, // 2
-    { 96, 46 }, // 3
-    { 79, 50 }, // 4
-    { 87, 50 }, // 5
-    { 96, 50 }, // 6
-    { 79, 56 }, // 7
-    { 87, 56 }, // 8
-    { 96, 56 }, // 9
-    { 79, 61 }, // *
-    { 96, 61 }, // #
+    NOTE(1336, 941, WHOLE | LAST, 0),           // 0
+    NOTE(1209, 697, WHOLE | LAST, 0),           // 1
+    NOTE(1336, 697, WHOLE | LAST, 0),           // 2
+    NOTE(1477, 697, WHOLE | LAST, 0),           // 3
+    NOTE(1209, 770, WHOLE | LAST, 0),           // 4
+    NOTE(1336, 770, WHOLE | LAST, 0),           // 5
+    NOTE(1477, 770, WHOLE | LAST, 0),           // 6
+    NOTE(1209, 852, WHOLE | LAST, 0),           // 7
+    NOTE(1336, 852, WHOLE | LAST, 0),           // 8
+    NOTE(1477, 852, WHOLE | LAST, 0),           // 9
+    NOTE(1209, 941, WHOLE | LAST, 0),           // *
+    NOTE(1477, 941, WHOLE | LAST, 0),           // #
+    NOTE_1(1000, WHOLE | LAST, 0),              // 12: beep
+    NOTE_1(500, WHOLE | LAST, 0),               // 13: low beep
+    NOTE_1(523.25, 5, 0),                       // 14: ascending tune, C E G
+    NOTE_1(659.26, 5, 0),
+    NOTE_1(784, 6 | LAST, 0),
+    NOTE_1(784, 5, 0),                          // 17: descending tune, G E C
+    NOTE_1(659.26, 5, 0),
+    NOTE_1(523.25, 6 | LAST, 0),
+    { 0, 0, WHOLE | LAST, 0 },                  // 20: silence, for anything else
 };
 
-volatile uint32_t _g_delay_counter;         // Delay counter for sleep function
-volatile uint8_t _g_stepwidth_a;                // step width of high frequency
-volatile uint8_t _g_stepwidth_b;                // step width of low frequency
-volatile uint16_t _g_cur_sin_val_a;             // position freq. A in LUT (extended format)
-volatile uint16_t _g_cur_sin_val_b;             // position freq. B in LUT (extended format)
+#define NOTE_SILENCE                20
+
+// First note of every sound, indexed by digit
+static const uint8_t _g_sounds[DTMF_SOUNDS] PROGMEM =
+{
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11,
+    12,                                         // DIGIT_BEEP
+    13,                                         // DIGIT_BEEP_LOW
+    14,                                         // DIGIT_TUNE_ASC
+    17,                                         // DIGIT_TUNE_DESC
+};
+
+static dtmf_queued_tone_t _g_queue[DTMF_QUEUE_SIZE];
+static uint8_t _g_queue_head;               // next entry to play
+static uint8_t _g_queue_count;
+static uint8_t _g_note;                     // next note of the sound playing
+static bool _g_more_notes;                  // that note belongs to it
+static uint16_t _g_duration_ms;             // the sound's queued duration
+static uint8_t _g_sound_gap;                // its queued gap, DTMF_QUEUE_UNIT_MS units
+static uint16_t _g_gap_ms;                  // gap still to come after the current note
+static bool _g_playing;                     // a tone or gap is timing out
+static uint16_t _g_delay_end;               // when it has
+static bool _g_delay_running;
+static uint8_t _g_number[DIGITS_PACKED_SIZE];   // a queued number, see dtmf_queue_number()
+static dtmf_queued_tone_t _g_number_tone;   // its timing and the digit playing
+static uint8_t _g_number_next;              // digit of it to play next
+static bool _g_number_queued;               // _g_number is queued or playing
+static bool _g_number_playing;
 
 void dtmf_init(void)
 {
-    TIMSK = _BV(TOIE0);                 // Int T0 Overflow enabled
-    TCCR0A = _BV(WGM00) | _BV(WGM01);   // 8Bit PWM; Compare/match output mode configured later
-    TCCR0B = TIMER_PRESCALE_MASK0 & TIMER_CLK_DIV1;
-    TCNT0 = 0;
-    OCR0A = 0;
-    DDRB |= _BV(PIN_PWM_OUT);    // PWM output (OC0A pin)
+    timer_init();                       // Timer0 is only switched to PWM while a tone plays
+    PWM_OCR = PWM_VALUE(0);
+    DDRB |= _BV(PIN_PWM_OUT);    // PWM output (OC0A / !OC1A pin)
 
-    _g_stepwidth_a = 0x00;
-    _g_stepwidth_b = 0x00;
+    dds_init();
 
-    _g_cur_sin_val_a = 0;
-    _g_cur_sin_val_b = 0;
+    dtmf_abort();
 
-    _g_delay_counter = 0;
+    // Hold back the first tone until the supply has settled. Only Timer0
+    // time counts, which stops in power down, so this never comes short
+    dtmf_set_ticks(T0_OVERFLOWS(DTMF_SUPPLY_SETTLE_MS));
 }
 
-// Generate DTMF tone, duration x ms
-void dtmf_generate_tone(int8_t digit, uint16_t duration_ms)
+// Queue a tone (digit or one of the DIGIT_ special tones) followed by
+// gap_ms of silence. Returns straight away; dtmf_poll() plays the queue.
+// False if the queue is full and the tone was dropped. Durations are kept
+// in DTMF_QUEUE_UNIT_MS steps, up to 255 of them
+bool dtmf_queue_tone(int8_t digit, uint16_t duration_ms, uint16_t gap_ms)
 {
-    GIMSK = 0; 
+    dtmf_queued_tone_t *tone;
 
-    if (digit >= 0 && digit <= DIGIT_POUND)
-    {
-        // Standard digits 0-9, *, #
-        _g_stepwidth_a = auc_frequency[digit][0];  
-        _g_stepwidth_b = auc_frequency[digit][1]; 
-        dtmf_enable_pwm();
+    if (_g_queue_count == DTMF_QUEUE_SIZE)
+        return false;
+
+    tone = &_g_queue[(_g_queue_head + _g_queue_count) % DTMF_QUEUE_SIZE];
+    tone->digit = digit;
+    tone->duration = duration_ms / DTMF_QUEUE_UNIT_MS;
+    tone->gap = gap_ms / DTMF_QUEUE_UNIT_MS;
+    _g_queue_count++;
+
+    return true;
+}
+
+// Queue a packed number (see digits.h), every digit with duration_ms of
+// tone and gap_ms of silence. It takes one queue entry: the digits are
+// copied and dtmf_poll() plays them one at a time when the entry comes up.
+// False if the queue is full or still has a number in it, and the number
+// was dropped
+bool dtmf_queue_number(const uint8_t *packed, uint16_t duration_ms, uint16_t gap_ms)
+{
+    if (_g_number_queued)
+        return false;
+
+    // Nothing to play
+    if (digits_get(packed, 0) == DIGIT_OFF)
+        return true;
+
+    if (!dtmf_queue_tone(QUEUED_NUMBER, duration_ms, gap_ms))
+        return false;
+
+    for (uint8_t i = 0; i < DIGITS_PACKED_SIZE; i++)
+        _g_number[i] = packed[i];
+
+    _g_number_queued = true;
+
+    return true;
+}
+
+// True while anything is queued or still playing
+bool dtmf_busy(void)
+{
+    return _g_playing || _g_queue_count;
+}
+
+// Drop everything queued and silence the current tone
+void dtmf_abort(void)
+{
+    if (_g_playing)
+        TRACE(TR_TONE_END, 1);
+
+    _g_queue_head = 0;
+    _g_queue_count = 0;
+    _g_number_queued = false;
+    _g_number_playing = false;
+    _g_more_notes = false;
+    _g_gap_ms = 0;
+    _g_playing = false;
 
-        // Wait x ms
-        sleep_ms(duration_ms);
-    } 
-    else if (digit == DIGIT_BEEP)
+    dtmf_set_ticks(0);
+    dtmf_disable_pwm();
+}
+
+// Keeps the queue moving. Call on every wake up (Timer0 wakes the CPU
+// every PWM period while a tone plays, and at the end of a gap); steps are
+// timed from when they start, so a late call only delays the next step,
+// never shortens it
+void dtmf_poll(void)
+{
+    if (!dtmf_delay_pending())
+        dtmf_advance();
+
+    if (_g_delay_running)
+        timer_wake_at(_g_delay_end);
+
+#ifdef DDS_BUFFERED
+    if (_g_stepwidth_a)
+        dds_fill();
+#endif
+}
+
+// Block until the queue has played out
+void dtmf_wait(void)
+{
+    while (dtmf_busy())
     {
-        // Beep ~1000Hz (66)
-        _g_stepwidth_a = 66;  
-        _g_stepwidth_b = 0;
-        dtmf_enable_pwm();
+        dtmf_poll();
 
-        // Wait x ms
-        sleep_ms(duration_ms);
+        if (dtmf_busy())
+            timer_idle();
     }
-    else if (digit == DIGIT_BEEP_LOW)
-    {
-        // Beep ~500Hz (33)
-        _g_stepwidth_a = 33;  
-        _g_stepwidth_b = 0;
-        dtmf_enable_pwm();
+}
 
-        // Wait x ms
-        sleep_ms(duration_ms);
+// Generate DTMF tone, duration x ms, and wait for it to finish
+void dtmf_generate_tone(int8_t digit, uint16_t duration_ms)
+{
+    dtmf_queue_tone(digit, duration_ms, 0);
+    dtmf_wait();
+}
+
+// Called once the current tick count has run out
+static void dtmf_advance(void)
+{
+    if (_g_gap_ms)
+    {
+        dtmf_disable_pwm();
+        dtmf_set_ticks(T0_OVERFLOWS(_g_gap_ms));
+        _g_gap_ms = 0;
     }
-    else if (digit == DIGIT_TUNE_ASC)
+    else if (_g_more_notes)
     {
-        _g_stepwidth_a = 34;    // C=523.25Hz  
-        _g_stepwidth_b = 0;
-        dtmf_enable_pwm();
-        
-        sleep_ms(duration_ms / 3);
-        _g_stepwidth_a = 43;    // E=659.26Hz
-        sleep_ms(duration_ms / 3);
-        _g_stepwidth_a = 51;    // G=784Hz
-        sleep_ms(duration_ms / 3);
+        dtmf_play_note();
     }
-    else if (digit == DIGIT_TUNE_DESC)
+    else if (!dtmf_next_digit())
     {
-        _g_stepwidth_a = 51;    // G=784Hz
-        _g_stepwidth_b = 0;
-        dtmf_enable_pwm();
+        if (_g_queue_count)
+        {
+            const dtmf_queued_tone_t *tone = &_g_queue[_g_queue_head];
+
+            _g_queue_head = (_g_queue_head + 1) % DTMF_QUEUE_SIZE;
+            _g_queue_count--;
 
-        sleep_ms(duration_ms / 3);
-        _g_stepwidth_a = 43;    // E=659.26Hz
-        sleep_ms(duration_ms / 3);
-        _g_stepwidth_a = 34;    // C=523.25Hz  
-        sleep_ms(duration_ms / 3);
+            if (tone->digit == QUEUED_NUMBER)
+            {
+                _g_number_tone = *tone;
+                _g_number_next = 0;
+                _g_number_playing = true;
+                dtmf_next_digit();
+            }
+            else
+            {
+                dtmf_start_sound(tone);
+            }
+        }
+        else if (_g_playing)
+        {
+            dtmf_disable_pwm();
+            _g_playing = false;
+            TRACE(TR_TONE_END, 0);
+        }
     }
+}
 
-    // Stop DTMF transmitting
-    // Disable PWM output (compare match mode 0) and force it to 0
-    TCCR0A &= ~_BV(COM0A1);
-    TCCR0A &= ~_BV(COM0A0);
-    PORTB &= ~_BV(PIN_PWM_OUT);
-    
-    _g_stepwidth_a = 0;
-    _g_stepwidth_b = 0;
+// Start the next digit of the number playing; false if no number is
+// playing or it has ended
+static bool dtmf_next_digit(void)
+{
+    int8_t digit = DIGIT_OFF;
 
-    GIMSK = _BV(INT0) | _BV(PCIE); 
+    if (!_g_number_playing)
+        return false;
+
+    if (_g_number_next < DIGITS_MAX)
+        digit = digits_get(_g_number, _g_number_next++);
+
+    if (digit == DIGIT_OFF)
+    {
+        _g_number_playing = false;
+        _g_number_queued = false;
+        return false;
+    }
+
+    _g_number_tone.digit = digit;
+    dtmf_start_sound(&_g_number_tone);
+
+    return true;
+}
+
+static void dtmf_start_sound(const dtmf_queued_tone_t *tone)
+{
+    uint8_t sound = (uint8_t)tone->digit;
+
+    // Anything that isn't a sound just times out the duration silently
+    _g_note = sound < DTMF_SOUNDS ? pgm_read_byte(&_g_sounds[sound]) : NOTE_SILENCE;
+    _g_duration_ms = (uint16_t)tone->duration * DTMF_QUEUE_UNIT_MS;
+    _g_sound_gap = tone->gap;
+    _g_playing = true;
+    TRACE(TR_TONE, tone->digit);
+
+    dtmf_play_note();
 }
 
-// Enable PWM output by configuring compare match mode - non inverting PWM
+// Every sound plays through here, one note per call; its gap and, after
+// the last note, the sound's own gap follow through dtmf_advance()
+static void dtmf_play_note(void)
+{
+    const dtmf_note_t *note = &_g_notes[_g_note++];
+    uint8_t len = pgm_read_byte(&note->len);
+    uint16_t step_a = pgm_read_word(&note->step_a);
+
+    _g_more_notes = !(len & DTMF_NOTE_LAST);
+    _g_gap_ms = _g_duration_ms * pgm_read_byte(&note->gap) / DTMF_NOTE_WHOLE;
+
+    if (!_g_more_notes)
+        _g_gap_ms += (uint16_t)_g_sound_gap * DTMF_QUEUE_UNIT_MS;
+
+    dtmf_set_steps(step_a, pgm_read_word(&note->step_b));
+    dtmf_set_ticks(T0_OVERFLOWS(_g_duration_ms * (len & ~DTMF_NOTE_LAST) / DTMF_NOTE_WHOLE));
+
+    if (step_a)
+        dtmf_enable_pwm();
+    else
+        dtmf_disable_pwm();
+}
+
+// Start the tone output
 static void dtmf_enable_pwm(void)
+{
+#ifdef DDS_BUFFERED
+    // Start with a full ring so the first samples are the new tone's
+    dds_fill();
+#endif
+    timer_fast();
+    dtmf_output_on();
+}
+
+// Stop DTMF transmitting, the pin is held low
+static void dtmf_disable_pwm(void)
+{
+    dtmf_output_off();
+    dtmf_set_steps(0, 0);
+#ifdef DDS_BUFFERED
+    dds_flush();
+#endif
+    timer_slow();
+}
+
+#ifdef DTMF_PLL_PWM
+// -DDTMF_PLL_PWM: Timer1 clocked from the 64MHz PLL makes the carrier,
+// 64MHz/256 = 250kHz with OCR1C = 0xFF, and Timer0 only sets the sample
+// rate. PB0 is !OC1A, so COM1A = 01 (OC1A itself is on PB1, the dial
+// contact, which stays an input and never sees it). The PLL and Timer1
+// only run while a tone plays
+static void dtmf_output_on(void)
+{
+    if (TCCR1)
+        return;
+
+    PRR &= ~_BV(PRTIM1);
+    PLLCSR = _BV(PLLE);
+
+    // PLOCK can read set before the PLL has actually settled
+    _delay_us(PLL_LOCK_US);
+
+    while (bit_is_clear(PLLCSR, PLOCK))
+        ;
+
+    PLLCSR |= _BV(PCKE);
+    OCR1C = 0xFF;
+    TCCR1 = _BV(PWM1A) | _BV(COM1A0) | _BV(CS10);
+}
+
+static void dtmf_output_off(void)
+{
+    TCCR1 = 0;
+    PLLCSR = 0;
+    PRR |= _BV(PRTIM1);
+    PORTB &= ~_BV(PIN_PWM_OUT);
+}
+#else
+// Configure compare match mode - non inverting PWM on OC0A
+static void dtmf_output_on(void)
 {
     TCCR0A |= _BV(COM0A1);
     TCCR0A &= ~_BV(COM0A0);
 }
 
+// Disable PWM output (compare match mode 0) and force it to 0
+static void dtmf_output_off(void)
+{
+    TCCR0A &= ~_BV(COM0A1);
+    TCCR0A &= ~_BV(COM0A0);
+    PORTB &= ~_BV(PIN_PWM_OUT);
+}
+#endif
+
+// Step widths are 16 bit, don't let the ISR see half an update
+static void dtmf_set_steps(uint16_t step_a, uint16_t step_b)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        _g_stepwidth_a = step_a;
+        _g_stepwidth_b = step_b;
+    }
+}
+
+// Time out the current step ticks from now
+static void dtmf_set_ticks(uint16_t ticks)
+{
+    _g_delay_end = timer_now() + ticks;
+    _g_delay_running = ticks != 0;
+}
+
+#ifndef DTMF_ASM_ISR
 // Timer overflow interrupt service routine
+// (DTMF_ASM_ISR builds use the hand written version in dtmf_isr.S)
 ISR(TIMER0_OVF_vect)
 { 
-    uint8_t sin_a;
-    uint8_t sin_b;
-
-    // A component (high frequency) is always used
-    // move Pointer about step width ahead
-    _g_cur_sin_val_a += _g_stepwidth_a;      
-    // normalize Temp-Pointer 
-    uint16_t tmp_sin_val_a = (int8_t)(((_g_cur_sin_val_a + 4) >> 3) & (0x007F)); 
-    sin_a = auc_sin_param[tmp_sin_val_a];
-
-    // B component (low frequency) is optional
-    if (_g_stepwidth_b > 0)
-    {
-        // move Pointer about step width ahead
-        _g_cur_sin_val_b += _g_stepwidth_b;    
+#ifdef DDS_BUFFERED
+    uint8_t tail = _g_sample_tail;
 
-        // normalize Temp-Pointer    
-        uint16_t tmp_sin_val_b = (int8_t)(((_g_cur_sin_val_b + 4) >> 3) & (0x007F));        
-        sin_b = auc_sin_param[tmp_sin_val_b];
-    }
-    else
+    // On underrun keep the previous sample
+    if (tail != _g_sample_head)
     {
-        sin_b = 0;
+        PWM_OCR = PWM_VALUE(_g_sample_buf[tail]);
+        _g_sample_tail = (tail + 1) & (DDS_BUF_SIZE - 1);
     }
+#else
+    PWM_OCR = PWM_VALUE(dds_next_sample());
+#endif
+
+    _g_timer_ticks++;
+}
+#endif
+
+static bool dtmf_delay_pending(void)
+{
+    if (_g_delay_running && timer_passed(_g_delay_end))
+        _g_delay_running = false;
 
-    // calculate PWM value: high frequency value + 3/4 low frequency value
-    OCR0A = (sin_a + (sin_b - (sin_b >> 2)));
-    _g_delay_counter++;
+    return _g_delay_running;
 }
 
-// Wait x ms
+// Wait x ms (after anything still queued has played)
 void sleep_ms(uint16_t msec)
 {    
-    _g_delay_counter = 0;
-    set_sleep_mode(SLEEP_MODE_IDLE);        
-    while(_g_delay_counter <= msec * T0_OVERFLOW_PER_MS)
+    dtmf_wait();
+
+    while (msec)
     {
-        sleep_mode();
+        uint16_t chunk = msec > SLEEP_MS_CHUNK ? SLEEP_MS_CHUNK : msec;
+
+        msec -= chunk;
+        dtmf_set_ticks(T0_OVERFLOWS(chunk));
+
+        while (dtmf_delay_pending())
+        {
+            timer_wake_at(_g_delay_end);
+            timer_idle();
+        }
     }
-}
\ No newline at end of file
+}
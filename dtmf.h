@@ -24,27 +24,67 @@
 #ifndef __DTMF_H__
 #define __DTMF_H__
 
-#define DIGIT_BEEP          -10
-#define DIGIT_BEEP_LOW      -13
-#define DIGIT_TUNE_ASC      -11
-#define DIGIT_TUNE_DESC     -12
+#include <stdbool.h>
+#include <stdint.h>
+#include <avr/pgmspace.h>
+
+// Everything dtmf_queue_tone() plays is a sound from the table in dtmf.c:
+// the twelve digits, then the beeps and tunes
 #define DIGIT_OFF           -1
 #define DIGIT_STAR          10
 #define DIGIT_POUND         11
+#define DIGIT_BEEP          12
+#define DIGIT_BEEP_LOW      13
+#define DIGIT_TUNE_ASC      14
+#define DIGIT_TUNE_DESC     15
+#define DTMF_SOUNDS         16
 
 #define DTMF_DURATION_MS    100
 
-// PWM frequency = 4Mhz/256 = 15625Hz; overflow cycles per MS = 15
-#define T0_OVERFLOW_PER_MS  15
+// No tone starts until this long after dtmf_init(): the PWM output draws
+// more than the decoupling capacitors can supply while they charge
+#define DTMF_SUPPLY_SETTLE_MS   128
+
+// Tone queue: 3 bytes an entry. A whole number takes one entry (see
+// dtmf_queue_number), so this is room for dialed digits and beeps while
+// a number plays. Durations and gaps are stored in DTMF_QUEUE_UNIT_MS
+// steps (max 1020ms)
+#define DTMF_QUEUE_SIZE     8
+#define DTMF_QUEUE_UNIT_MS  4
+
+// PWM frequency = F_CPU/256 (15625Hz at 4MHz); Timer0 overflows in x ms, rounded
+// (needs dds.h for DDS_PWM_BITS)
+#define T0_OVERFLOWS(ms)    ((uint16_t)(((uint32_t)(ms) * (F_CPU / 1000) + (1 << (DDS_PWM_BITS - 1))) >> DDS_PWM_BITS))
 
 #define PIN_PWM_OUT         PB0     // PB0 (OC0A) as PWM output
 
+// One note of a sound. Length and gap are in DTMF_NOTE_WHOLE parts of the
+// duration the sound was queued with (up to 4 wholes each, so a 1020ms
+// sound still fits 16 bits); DTMF_NOTE_LAST marks the end
+#define DTMF_NOTE_WHOLE     16
+#define DTMF_NOTE_LAST      0x80
+
+typedef struct
+{
+    uint16_t step_a;                        // high frequency step width, 0 for silence
+    uint16_t step_b;                        // low frequency step width, 0 for a single tone
+    uint8_t len;                            // length, plus DTMF_NOTE_LAST on the last note
+    uint8_t gap;                            // silence after it
+} dtmf_note_t;
+
+// Notes 0-11 are the DTMF digits, in order (the host tools use them)
+extern const dtmf_note_t _g_notes[] PROGMEM;
+
 void dtmf_init(void);
+bool dtmf_queue_tone(int8_t digit, uint16_t duration_ms, uint16_t gap_ms);
+bool dtmf_queue_number(const uint8_t *packed, uint16_t duration_ms, uint16_t gap_ms);
+bool dtmf_busy(void);
+void dtmf_abort(void);
+void dtmf_poll(void);
+void dtmf_wait(void);
 void dtmf_generate_tone(int8_t digit, uint16_t duration_ms);
 void sleep_ms(uint16_t msec);
 
-extern volatile uint32_t _g_delay_counter;
-
 #endif /* __DTMF_H__ */
 
 
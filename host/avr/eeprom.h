@@ -0,0 +1,35 @@
+//*****************************************************************************
+// Title        : Host stand-in for <avr/eeprom.h>
+// Author       : agent
+// Created      : 2026-10-16
+//
+// Part of the pulse to tone (DTMF) converter.
+//
+// This code is distributed under the GNU Public License
+// which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+// Host stand-in for <avr/eeprom.h>. EEMEM variables are collected in their
+// own section so eeprom.c can count writes per cell, like the real part
+// wears them.
+
+#ifndef __HOST_AVR_EEPROM_H__
+#define __HOST_AVR_EEPROM_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define EEMEM                   __attribute__((section("eeprom"), used))
+
+uint8_t eeprom_read_byte(const uint8_t *p);
+void eeprom_read_block(void *dst, const void *src, size_t n);
+void eeprom_update_byte(uint8_t *p, uint8_t value);
+void eeprom_update_block(const void *src, void *dst, size_t n);
+
+// Test hooks (see eeprom.c)
+uint32_t host_eeprom_size(void);
+uint32_t host_eeprom_writes(const void *p);
+void host_eeprom_fail_after(int32_t writes);
+
+#endif /* __HOST_AVR_EEPROM_H__ */
@@ -0,0 +1,32 @@
+//*****************************************************************************
+// Title        : Host stand-in for <avr/interrupt.h>
+// Author       : agent
+// Created      : 2026-10-16
+//
+// Part of the pulse to tone (DTMF) converter.
+//
+// This code is distributed under the GNU Public License
+// which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+// Host stand-in for <avr/interrupt.h>. ISRs become plain functions which
+// the host side (hal.c) calls when it advances simulated time.
+
+#ifndef __HOST_AVR_INTERRUPT_H__
+#define __HOST_AVR_INTERRUPT_H__
+
+#include <avr/io.h>
+
+#define ISR(vector, ...)    void vector(void)
+#define sei()               ((void)0)
+#define cli()               ((void)0)
+
+void TIMER0_OVF_vect(void);
+void TIMER0_COMPA_vect(void);
+void TIMER0_COMPB_vect(void);
+void INT0_vect(void);
+void PCINT0_vect(void);
+void WDT_vect(void);
+
+#endif /* __HOST_AVR_INTERRUPT_H__ */
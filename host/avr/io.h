@@ -0,0 +1,128 @@
+//*****************************************************************************
+// Title        : Host stand-in for <avr/io.h>
+// Author       : agent
+// Created      : 2026-10-16
+//
+// Part of the pulse to tone (DTMF) converter.
+//
+// This code is distributed under the GNU Public License
+// which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+// Minimal stand-in for <avr/io.h> so the firmware sources compile natively.
+// Only the ATtiny85 registers and bits the firmware touches are provided;
+// bit numbers match the real part.
+
+#ifndef __HOST_AVR_IO_H__
+#define __HOST_AVR_IO_H__
+
+#include <stdint.h>
+
+#define _BV(bit)                (1 << (bit))
+#define bit_is_set(sfr, bit)    ((sfr) & _BV(bit))
+#define bit_is_clear(sfr, bit)  (!((sfr) & _BV(bit)))
+
+extern volatile uint8_t TIMSK;
+extern volatile uint8_t TCCR0A;
+extern volatile uint8_t TCCR0B;
+extern volatile uint8_t TCNT0;
+extern volatile uint8_t OCR0A;
+extern volatile uint8_t OCR0B;
+extern volatile uint8_t DDRB;
+extern volatile uint8_t PORTB;
+extern volatile uint8_t PINB;
+extern volatile uint8_t GIMSK;
+extern volatile uint8_t TCCR1;
+extern volatile uint8_t OCR1A;
+extern volatile uint8_t OCR1C;
+extern volatile uint8_t PRR;
+
+// Interrupt flags: the host models run an ISR as soon as its flag would be
+// set, so they always read clear (and writing a one clears them anyway)
+#define TIFR        (*host_tifr())
+volatile uint8_t *host_tifr(void);
+
+// The PLL locks as soon as it is enabled
+#define PLLCSR      (*host_pllcsr())
+volatile uint8_t *host_pllcsr(void);
+
+// Only modelled by dialfuzz.c, which runs main.c
+extern volatile uint8_t CLKPR;
+extern volatile uint8_t ACSR;
+extern volatile uint8_t MCUCR;
+extern volatile uint8_t MCUSR;
+extern volatile uint8_t PCMSK;
+extern volatile uint8_t WDTCR;
+
+// TIMSK
+#define TOIE0       1
+#define OCIE0B      3
+#define OCIE0A      4
+
+// TIFR
+#define TOV0        1
+#define OCF0B       3
+#define OCF0A       4
+
+// TCCR0B
+#define CS00        0
+#define CS01        1
+#define CS02        2
+
+// TCCR0A
+#define WGM00       0
+#define WGM01       1
+#define COM0A0      6
+#define COM0A1      7
+
+// TCCR1
+#define CS10        0
+#define COM1A0      4
+#define COM1A1      5
+#define PWM1A       6
+
+// PLLCSR
+#define PLOCK       0
+#define PLLE        1
+#define PCKE        2
+
+// GIMSK
+#define PCIE        5
+#define INT0        6
+
+// CLKPR
+#define CLKPCE      7
+
+// PRR
+#define PRADC       0
+#define PRUSI       1
+#define PRTIM0      2
+#define PRTIM1      3
+
+// ACSR
+#define ACD         7
+
+// MCUCR
+#define ISC00       0
+#define ISC01       1
+
+// WDTCR
+#define WDP0        0
+#define WDP1        1
+#define WDP2        2
+#define WDE         3
+#define WDCE        4
+#define WDP3        5
+#define WDIE        6
+#define WDIF        7
+
+// PORTB
+#define PB0         0
+#define PB1         1
+#define PB2         2
+#define PB3         3
+#define PB4         4
+#define PB5         5
+
+#endif /* __HOST_AVR_IO_H__ */
@@ -0,0 +1,24 @@
+//*****************************************************************************
+// Title        : Host stand-in for <avr/pgmspace.h>
+// Author       : agent
+// Created      : 2026-10-16
+//
+// Part of the pulse to tone (DTMF) converter.
+//
+// This code is distributed under the GNU Public License
+// which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+// Host stand-in for <avr/pgmspace.h>. There is only one address space.
+
+#ifndef __HOST_AVR_PGMSPACE_H__
+#define __HOST_AVR_PGMSPACE_H__
+
+#include <stdint.h>
+
+#define PROGMEM
+#define pgm_read_byte(addr)     (*(const uint8_t *)(addr))
+#define pgm_read_word(addr)     (*(const uint16_t *)(addr))
+
+#endif /* __HOST_AVR_PGMSPACE_H__ */
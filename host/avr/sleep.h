@@ -0,0 +1,36 @@
+//*****************************************************************************
+// Title        : Host stand-in for <avr/sleep.h>
+// Author       : agent
+// Created      : 2026-10-16
+//
+// Part of the pulse to tone (DTMF) converter.
+//
+// This code is distributed under the GNU Public License
+// which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+// Host stand-in for <avr/sleep.h>. Going to sleep advances simulated time
+// to the next interrupt, see host_sleep() in hal.c
+
+#ifndef __HOST_AVR_SLEEP_H__
+#define __HOST_AVR_SLEEP_H__
+
+#include <stdint.h>
+
+#define SLEEP_MODE_IDLE         0
+#define SLEEP_MODE_ADC          1
+#define SLEEP_MODE_PWR_DOWN     2
+
+extern uint8_t host_sleep_mode;
+
+void host_sleep(void);
+
+#define set_sleep_mode(mode)    (host_sleep_mode = (mode))
+#define sleep_enable()          ((void)0)
+#define sleep_disable()         ((void)0)
+#define sleep_bod_disable()     ((void)0)
+#define sleep_cpu()             host_sleep()
+#define sleep_mode()            host_sleep()
+
+#endif /* __HOST_AVR_SLEEP_H__ */
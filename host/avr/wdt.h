@@ -0,0 +1,23 @@
+//*****************************************************************************
+// Title        : Host stand-in for <avr/wdt.h>
+// Author       : agent
+// Created      : 2026-10-16
+//
+// Part of the pulse to tone (DTMF) converter.
+//
+// This code is distributed under the GNU Public License
+// which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+// Host stand-in for <avr/wdt.h>. The watchdog period restarts on every
+// wdt_reset(), so the board model needs to see them.
+
+#ifndef __HOST_AVR_WDT_H__
+#define __HOST_AVR_WDT_H__
+
+void host_wdt_reset(void);
+
+#define wdt_reset()             host_wdt_reset()
+
+#endif /* __HOST_AVR_WDT_H__ */
@@ -0,0 +1,1127 @@
+//*****************************************************************************
+// Title        : Dial logic fuzzer
+// Author       : agent
+// Created      : 2026-10-16
+//
+// Part of the pulse to tone (DTMF) converter.
+//
+// This code is distributed under the GNU Public License
+// which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+// Fuzzes the dial logic. main.c itself runs on a host model of the
+// ATtiny85 (Timer0, INT0, pin change, watchdog and sleep modes) and is fed
+// random dialing, one forked process per scenario so every run starts from
+// power up, on all cores at once.
+//
+//   dialfuzz [-n scenarios] [-t seconds] [-j jobs] [-s seed [-v] [-T file]]
+//   dialfuzz -b [-s first_break_ms [-v]]
+//
+// A scenario is a random mix of clean digits, sloppy ones (any rate,
+// break ratio and bounce, 0-15 pulses), holds into the special functions,
+// glitches on either contact and pauses. After every sleep and every
+// queued tone the firmware is checked:
+//
+//   - the menu state and the speed dial indices are in range
+//   - only digits 0-11 and the beeps and tunes are queued, for no longer
+//     than the queue can hold, and none is dropped for want of room
+//   - it never powers down with tones queued or the dial off normal, and
+//     is back in power down with the watchdog off within 30 s (simulated)
+//     of the last input
+//
+// Idle time jumps straight to the next input, Timer0 interrupt or
+// watchdog interrupt, so main.c only runs on the wake ups the chip would
+// have, mostly the tone samples. That is about a millisecond per scenario,
+// less than the fork: measured on one core, about 200 scenarios per second
+// under the sanitizers and 500 for dialfuzz-fast (host/Makefile), which
+// drops them for long bulk runs.
+//
+// Scenarios of clean digits only must also produce exactly those tones and
+// leave them in the redial memory. Some of them end by programming a speed
+// dial position with pauses longer than the 2 s commit wake in between,
+// which must play the programming beeps and leave the whole number there.
+// host/Makefile builds this with the sanitizers, so out of range table
+// reads abort the scenario too.
+// -s runs a single seed in the foreground to reproduce a failure; -v also
+// lists its input and the tones queued.
+//
+// Built with -DTRACE_RING -DTRACE_UART (dialfuzz-trace in host/Makefile),
+// every trace dump (L2-2) is read back off PB0 a bit at a time and its
+// framing, checksum and events checked.
+// -T also dumps the trace at the end of the seed and writes what was sent
+// to a file for host/tracedump.
+//
+// -b measures the cold start instead: one clean digit with its first break
+// at every BOOT_STEP_MS of the first BOOT_SWEEP_MS after reset, the dial
+// already off normal at power up for the earlier ones (the phone powered by
+// lifting the handset). Every digit must still be decoded, and no tone may
+// start before DTMF_SUPPLY_SETTLE_MS. It reports from when a first break is
+// no longer lost and the reset to first pulse accepted and first tone times.
+// Reset here is where main() starts; add the start up delay the fuses set
+// (16K CK + 64 ms with the crystal fuses in Makefile). Failures name the
+// first break in ms as the seed, -b -s reruns one.
+
+#include <setjmp.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+// The firmware, with tones and trace dumps going through the checks below
+#define main                    firmware_main
+#define dtmf_queue_tone         fuzz_queue_tone
+#define dtmf_queue_number       fuzz_queue_number
+#if defined(TRACE_RING) && defined(TRACE_UART)
+#define trace_dump              fuzz_trace_dump
+#endif
+#include "../main.c"
+#undef main
+#undef dtmf_queue_tone
+#undef dtmf_queue_number
+#undef trace_dump
+
+#include "hal.h"
+#include "../dds.h"
+
+bool dtmf_queue_tone(int8_t digit, uint16_t duration_ms, uint16_t gap_ms);
+bool dtmf_queue_number(const uint8_t *packed, uint16_t duration_ms, uint16_t gap_ms);
+void trace_dump(void);
+
+#define DEFAULT_SCENARIOS       10000
+#define MAX_INPUTS              16384
+#define MAX_TONES               1024
+#define MAX_DIGITS              64
+
+#define TICK_US                 (256 * 1000000UL / F_CPU)
+#define START_US                500000UL    // after the power up delay
+#define SETTLE_LIMIT_US         30000000UL
+#define HANG_SECONDS            10
+#define MAX_DUMP                (5 + 4 * 256 + 1)
+#define BOOT_SWEEP_MS           400     // first breaks from reset up to this
+#define BOOT_STEP_MS            2
+#define BOOT_WINDUP_MS          200     // off normal this long before the first break
+
+typedef struct
+{
+    uint32_t us;
+    uint16_t seq;                           // keeps equal times in order
+    uint8_t pin;
+    uint8_t level;
+} input_t;
+
+typedef struct
+{
+    input_t inputs[MAX_INPUTS];
+    int count;
+    bool exact;                             // clean digits only
+    int8_t expected[MAX_DIGITS];            // dialed, so in the redial memory
+    int expected_count;
+    int8_t tones[MAX_TONES];                // all the tones to be queued
+    int tone_count;
+    int8_t position;                        // digit of the position programmed, -1 if none
+    int8_t program[MAX_DIGITS];
+    int program_count;
+    bool played_back;                       // position dialed after it, see add_playback()
+    uint32_t end_us;
+    uint8_t pinb;                           // contacts at power up
+} scenario_t;
+
+typedef struct
+{
+    uint32_t first_break_us;
+    uint32_t first_pulse_us;                // first pulse counted, 0 if none
+    uint32_t first_tone_us;                 // tone output first started, 0 if never
+} boot_result_t;
+
+volatile uint8_t TIMSK;
+volatile uint8_t TCCR0A;
+volatile uint8_t TCCR0B;
+volatile uint8_t TCNT0;
+volatile uint8_t OCR0A;
+volatile uint8_t OCR0B;
+volatile uint8_t DDRB;
+volatile uint8_t PORTB;
+volatile uint8_t PINB;
+volatile uint8_t GIMSK;
+volatile uint8_t TCCR1;
+volatile uint8_t OCR1A;
+volatile uint8_t OCR1C;
+volatile uint8_t CLKPR;
+volatile uint8_t PRR;
+volatile uint8_t ACSR;
+volatile uint8_t MCUCR;
+volatile uint8_t MCUSR;
+volatile uint8_t PCMSK;
+volatile uint8_t WDTCR;
+
+uint8_t host_sleep_mode;
+
+static scenario_t _g_sc;
+static uint32_t _g_seed;
+static int _g_next_input;
+static uint32_t _g_now_us;
+static uint32_t _g_wdt_start_us;
+static int8_t _g_tones[MAX_TONES];
+static int _g_tone_count;
+static bool _g_verbose;
+static uint32_t _g_wakeups;                 // from idle
+static uint8_t _g_dump[MAX_DUMP];           // bytes read off PB0 by the last trace dump
+static int _g_dump_len;
+static int _g_uart_bits;                    // of the byte coming in, 0 while idle
+static uint16_t _g_uart_byte;
+static uint16_t _g_uart_loops;              // delay per bit, all must match
+static jmp_buf _g_done;
+static bool _g_boot;                        // -b
+static uint32_t _g_first_pulse_us;
+static uint32_t _g_first_tone_us;
+
+static void print_tones(void)
+{
+    printf("Tones:");
+
+    for (int i = 0; i < _g_tone_count; i++)
+        printf(" %d", _g_tones[i]);
+
+    if (_g_sc.exact)
+    {
+        printf("\nExpected:");
+
+        for (int i = 0; i < _g_sc.tone_count; i++)
+            printf(" %d", _g_sc.tones[i]);
+    }
+
+    printf("\n");
+}
+
+static void fail(const char *msg)
+{
+    if (_g_verbose)
+        print_tones();
+
+    fflush(stdout);
+    fprintf(stderr, "seed %u, %u.%03u s: %s\n", _g_seed, _g_now_us / 1000000, _g_now_us / 1000 % 1000, msg);
+    _exit(1);
+}
+
+// xorshift32, so a seed means the same scenario everywhere
+static uint32_t rnd(uint32_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+
+    return *state;
+}
+
+static uint32_t rnd_range(uint32_t *state, uint32_t lo, uint32_t hi)
+{
+    return lo + rnd(state) % (hi - lo + 1);
+}
+
+static void add_input(scenario_t *sc, uint32_t us, uint8_t pin, bool level)
+{
+    if (sc->count == MAX_INPUTS)
+        return;
+
+    sc->inputs[sc->count].us = us;
+    sc->inputs[sc->count].seq = sc->count;
+    sc->inputs[sc->count].pin = pin;
+    sc->inputs[sc->count].level = level;
+    sc->count++;
+}
+
+// A contact moving to level, chattering on the way. Returns when it settles
+static uint32_t add_contact(scenario_t *sc, uint32_t *st, uint32_t us, uint8_t pin, bool level,
+    int bounces, uint32_t bounce_us)
+{
+    for (int i = rnd_range(st, 0, bounces); i > 0; i--)
+    {
+        add_input(sc, us, pin, level);
+        us += rnd_range(st, 20, bounce_us);
+        add_input(sc, us, pin, !level);
+        us += rnd_range(st, 20, bounce_us);
+    }
+
+    add_input(sc, us, pin, level);
+
+    return us;
+}
+
+// One turn of the dial: off normal, wound up and maybe held, the pulses,
+// back at rest. pps is in tenths. Returns when the dial is at rest
+static uint32_t add_dial(scenario_t *sc, uint32_t *st, uint32_t us, int pulses, uint32_t pps,
+    uint32_t break_percent, int bounces, uint32_t bounce_us, uint32_t windup_ms, bool spikes)
+{
+    uint32_t period = 10000000UL / pps;
+    uint32_t brk = period * break_percent / 100;
+
+    us = add_contact(sc, st, us, PIN_DIAL, false, bounces, bounce_us);
+    us += windup_ms * 1000;
+
+    for (int i = 0; i < pulses; i++)
+    {
+        add_contact(sc, st, us, PIN_PULSE, true, bounces, bounce_us);
+
+        if (spikes && rnd(st) % 3 == 0)
+        {
+            uint32_t at = us + rnd_range(st, 0, brk);
+
+            add_input(sc, at, PIN_PULSE, false);
+            add_input(sc, at + rnd_range(st, 20, 6000), PIN_PULSE, true);
+        }
+
+        add_contact(sc, st, us + brk, PIN_PULSE, false, bounces, bounce_us);
+        us += period;
+    }
+
+    // The rest contact closes during the last make
+    if (pulses)
+        us -= rnd_range(st, 0, (period - brk) * 3 / 4);
+
+    return add_contact(sc, st, us, PIN_DIAL, true, bounces, bounce_us);
+}
+
+static uint32_t add_clean_digit(scenario_t *sc, uint32_t *st, uint32_t us, int digit, uint32_t windup_ms)
+{
+    return add_dial(sc, st, us, digit ? digit : 10, rnd_range(st, 80, 120), rnd_range(st, 55, 70),
+        3, 800, windup_ms, false);
+}
+
+static void expect_tone(scenario_t *sc, int8_t tone)
+{
+    if (sc->tone_count < MAX_TONES)
+        sc->tones[sc->tone_count++] = tone;
+}
+
+// Hold into L2, pick a position and program a number into it, some digits
+// after a pause long enough for the staged ones to be committed
+static uint32_t add_program(scenario_t *sc, uint32_t *st, uint32_t us)
+{
+    static const int8_t positions[] = { 4, 5, 6, 7, 8, 9, 0 };
+    int count = rnd_range(st, 1, DIGITS_MAX - 1);
+
+    sc->position = positions[rnd(st) % sizeof(positions)];
+    us = add_clean_digit(sc, st, us, sc->position, rnd_range(st, 4500, 6000));
+    expect_tone(sc, DIGIT_BEEP_LOW);
+    expect_tone(sc, DIGIT_TUNE_ASC);
+
+    for (int i = 0; i < count; i++)
+    {
+        int digit = rnd_range(st, 0, 9);
+
+        us += rnd(st) % 3 ? rnd_range(st, 250, 1500) * 1000 : rnd_range(st, 2500, 8000) * 1000;
+        us = add_clean_digit(sc, st, us, digit, rnd_range(st, 100, 1500));
+        sc->program[sc->program_count++] = digit;
+        expect_tone(sc, DIGIT_BEEP_LOW);
+    }
+
+    return us;
+}
+
+// Once the number programmed is committed, dial its position from L1 and
+// a digit straight after it. The digit must play after the number, also
+// when it comes in while the number is still playing
+static uint32_t add_playback(scenario_t *sc, uint32_t *st, uint32_t us)
+{
+    int digit = rnd_range(st, 0, 9);
+
+    us += rnd_range(st, 2500, 8000) * 1000;
+    us = add_clean_digit(sc, st, us, sc->position, rnd_range(st, 2400, 3800));
+    expect_tone(sc, DIGIT_BEEP_LOW);
+
+    for (int i = 0; i < sc->program_count; i++)
+        expect_tone(sc, sc->program[i]);
+
+    us = add_clean_digit(sc, st, us + rnd_range(st, 250, 1000) * 1000, digit, rnd_range(st, 100, 1500));
+    expect_tone(sc, digit);
+    sc->played_back = true;
+
+    return us;
+}
+
+static int compare_inputs(const void *a, const void *b)
+{
+    const input_t *x = a;
+    const input_t *y = b;
+
+    if (x->us != y->us)
+        return x->us < y->us ? -1 : 1;
+
+    return x->seq - y->seq;
+}
+
+static void generate(scenario_t *sc, uint32_t seed)
+{
+    uint32_t st = seed * 2654435761UL + 1;
+    uint32_t us = START_US;
+    int steps;
+
+    sc->count = 0;
+    sc->expected_count = 0;
+    sc->tone_count = 0;
+    sc->position = -1;
+    sc->program_count = 0;
+    sc->played_back = false;
+    sc->exact = rnd(&st) % 2;
+    steps = rnd_range(&st, 1, sc->exact ? 40 : 16);
+
+    for (int i = 0; i < steps; i++)
+    {
+        uint32_t kind = sc->exact ? rnd(&st) % 80 : rnd(&st) % 100;
+        int digit = rnd_range(&st, 0, 9);
+
+        if (kind < 60)
+        {
+            // Clean digit, wound up quickly enough not to start a special function
+            us = add_clean_digit(sc, &st, us, digit, rnd_range(&st, 100, 1500));
+
+            if (sc->expected_count < MAX_DIGITS)
+                sc->expected[sc->expected_count++] = digit;
+
+            expect_tone(sc, digit);
+        }
+        else if (kind < 80)
+        {
+            // A pause long enough to commit what has been staged
+            us += rnd_range(&st, 2500, 8000) * 1000;
+        }
+        else if (kind < 88)
+        {
+            // Any rate, ratio and contact quality
+            us = add_dial(sc, &st, us, rnd_range(&st, 0, 15), rnd_range(&st, 30, 300), rnd_range(&st, 10, 90),
+                10, 3000, rnd_range(&st, 0, 6000), true);
+        }
+        else if (kind < 95)
+        {
+            // Held into L1 or L2, clear of the window edges, then a digit
+            us = add_clean_digit(sc, &st, us, digit, rnd(&st) % 2 ? rnd_range(&st, 2400, 3800) : rnd_range(&st, 4500, 6000));
+        }
+        else if (kind < 98)
+        {
+            // The rest contact opening for a moment
+            add_input(sc, us, PIN_DIAL, false);
+            us += rnd_range(&st, 20, 5000);
+            add_input(sc, us, PIN_DIAL, true);
+        }
+        else
+        {
+            // Noise on the pulse contact with the dial at rest
+            us = add_contact(sc, &st, us, PIN_PULSE, true, 4, 3000);
+            us = add_contact(sc, &st, us + rnd_range(&st, 20, 20000), PIN_PULSE, false, 4, 3000);
+        }
+
+        us += rnd_range(&st, 250, 1500) * 1000;
+    }
+
+    // Programming stays on until the dial is held again or the line drops,
+    // so only as the last thing in a scenario
+    if (sc->exact && rnd(&st) % 3 == 0)
+    {
+        us = add_program(sc, &st, us);
+
+        if (rnd(&st) % 2)
+            us = add_playback(sc, &st, us);
+    }
+
+    qsort(sc->inputs, sc->count, sizeof(input_t), compare_inputs);
+    sc->end_us = us;
+    sc->pinb = _BV(PIN_DIAL);
+}
+
+// -b: a clean 10 pps digit with its first break first_break_ms after reset
+static void generate_boot(scenario_t *sc, uint32_t first_break_ms)
+{
+    uint32_t st = first_break_ms * 2654435761UL + 1;
+    uint32_t off_normal_ms = first_break_ms > BOOT_WINDUP_MS ? first_break_ms - BOOT_WINDUP_MS : 0;
+    int digit = first_break_ms / BOOT_STEP_MS % 10;
+    uint32_t us;
+
+    sc->count = 0;
+    sc->exact = true;
+    sc->expected[0] = digit;
+    sc->expected_count = 1;
+    sc->tones[0] = digit;
+    sc->tone_count = 1;
+    sc->position = -1;
+    sc->program_count = 0;
+    sc->played_back = false;
+
+    us = add_dial(sc, &st, off_normal_ms * 1000, digit ? digit : 10, 100, 60, 0, 0,
+        first_break_ms - off_normal_ms, false);
+
+    qsort(sc->inputs, sc->count, sizeof(input_t), compare_inputs);
+    sc->end_us = us + 1000000;
+    sc->pinb = off_normal_ms ? _BV(PIN_DIAL) : 0;
+}
+
+static void generate_seed(uint32_t seed)
+{
+    _g_seed = seed;
+
+    if (_g_boot)
+        generate_boot(&_g_sc, seed);
+    else
+        generate(&_g_sc, seed);
+}
+
+// The watchdog period set in WDTCR, 0 if its interrupt is off
+static uint32_t wdt_period_us(void)
+{
+    uint8_t prescale = (WDTCR & (_BV(WDP0) | _BV(WDP1) | _BV(WDP2))) | ((WDTCR & _BV(WDP3)) ? 8 : 0);
+
+    if (!(WDTCR & _BV(WDIE)))
+        return 0;
+
+    return 16000UL << prescale;
+}
+
+void host_wdt_reset(void)
+{
+    _g_wdt_start_us = _g_now_us;
+}
+
+// Apply one input; true if it interrupts the CPU (only the pin change
+// can while powered down)
+static bool apply_input(const input_t *input, bool awake)
+{
+    bool old = bit_is_set(PINB, input->pin);
+    bool wake = false;
+
+    if (old == input->level)
+        return false;
+
+    if (input->level)
+        PINB |= _BV(input->pin);
+    else
+        PINB &= ~_BV(input->pin);
+
+    // Edge triggered INT0 needs the clock, so it misses edges in power down
+    if (input->pin == PIN_PULSE && (GIMSK & _BV(INT0)) && awake)
+    {
+        uint8_t sense = MCUCR & (_BV(ISC01) | _BV(ISC00));
+
+        if (sense == _BV(ISC00) || (sense == _BV(ISC01) && !input->level) ||
+            (sense == (_BV(ISC01) | _BV(ISC00)) && input->level))
+        {
+            INT0_vect();
+            wake = true;
+        }
+    }
+
+    if ((GIMSK & _BV(PCIE)) && (PCMSK & _BV(input->pin)))
+    {
+        PCINT0_vect();
+        wake = true;
+    }
+
+    return wake;
+}
+
+static void check_state(void)
+{
+    runstate_t *rs = &_g_run_state;
+
+    if (rs->state >= STATE_COUNT)
+        fail("menu state out of range");
+
+    if (rs->speed_dial_digit_index > SPEED_DIAL_SIZE)
+        fail("speed_dial_digit_index past SPEED_DIAL_SIZE");
+
+    if (rs->speed_dial_index >= SPEED_DIAL_COUNT)
+        fail("speed_dial_index out of range");
+
+    if (rs->commit_index < -1 || rs->commit_index >= SPEED_DIAL_COUNT)
+        fail("commit_index out of range");
+
+    if (_g_now_us > _g_sc.end_us + SETTLE_LIMIT_US)
+        fail("still awake 30 s after the last input");
+}
+
+// Start up: the first pulse counted and the first tone out. Only as the
+// firmware goes to sleep, as pulse_count() polls (and sets a wake up)
+static void check_start(void)
+{
+    if (!_g_first_pulse_us && pulse_active() && pulse_count())
+        _g_first_pulse_us = _g_now_us;
+
+    if (!_g_first_tone_us && _g_stepwidth_a)
+    {
+        _g_first_tone_us = _g_now_us;
+
+        if (_g_first_tone_us < DTMF_SUPPLY_SETTLE_MS * 1000UL)
+            fail("tone started before the supply settled");
+    }
+}
+
+// Timer0 periods until the given time has been reached, at least one
+static uint32_t periods_until(uint32_t us)
+{
+    if (us <= _g_now_us + TICK_US)
+        return 1;
+
+    return (us - _g_now_us + TICK_US - 1) / TICK_US;
+}
+
+// Board model: idle jumps Timer0 straight to the period of the next input,
+// Timer0 interrupt or watchdog interrupt, power down to the next pin change
+// or watchdog interrupt. Power down with nothing left to wake up for ends
+// the scenario
+void host_sleep(void)
+{
+    uint32_t period = wdt_period_us();
+
+    check_state();
+    check_start();
+
+    if (host_sleep_mode == SLEEP_MODE_IDLE)
+    {
+        bool woken = false;
+
+        while (!woken)
+        {
+            // Idle with nothing left to wake it runs into the settle limit
+            uint32_t skip = host_timer0_wake();
+            uint32_t next;
+
+            if (_g_next_input < _g_sc.count && periods_until(_g_sc.inputs[_g_next_input].us) < skip)
+                skip = periods_until(_g_sc.inputs[_g_next_input].us);
+
+            if (period && periods_until(_g_wdt_start_us + period) < skip)
+                skip = periods_until(_g_wdt_start_us + period);
+
+            if (periods_until(_g_sc.end_us + SETTLE_LIMIT_US + 1) < skip)
+                skip = periods_until(_g_sc.end_us + SETTLE_LIMIT_US + 1);
+
+            host_timer0_skip(skip - 1);
+            _g_now_us += (skip - 1) * TICK_US;
+            next = _g_now_us + TICK_US;
+
+            while (_g_next_input < _g_sc.count && _g_sc.inputs[_g_next_input].us <= next)
+            {
+                _g_now_us = _g_sc.inputs[_g_next_input].us;
+                woken |= apply_input(&_g_sc.inputs[_g_next_input++], true);
+            }
+
+            _g_now_us = next;
+
+            if (period && _g_now_us >= _g_wdt_start_us + period)
+            {
+                _g_wdt_start_us += period;
+                WDT_vect();
+                woken = true;
+            }
+
+            woken |= host_timer0_tick();
+
+            if (!woken)
+                check_state();
+        }
+
+        _g_wakeups++;
+        return;
+    }
+
+    if (dtmf_busy())
+        fail("powered down with tones queued");
+
+    if (pulse_active())
+        fail("powered down while counting pulses");
+
+    while (_g_next_input < _g_sc.count && (!period || _g_sc.inputs[_g_next_input].us < _g_wdt_start_us + period))
+    {
+        _g_now_us = _g_sc.inputs[_g_next_input].us;
+
+        if (apply_input(&_g_sc.inputs[_g_next_input++], false))
+            return;
+    }
+
+    if (!period)
+        longjmp(_g_done, 1);
+
+    _g_now_us = _g_wdt_start_us + period;
+    _g_wdt_start_us += period;
+    WDT_vect();
+}
+
+bool fuzz_queue_tone(int8_t digit, uint16_t duration_ms, uint16_t gap_ms)
+{
+    if ((digit < 0 || digit > DIGIT_POUND) && digit != DIGIT_BEEP && digit != DIGIT_BEEP_LOW &&
+        digit != DIGIT_TUNE_ASC && digit != DIGIT_TUNE_DESC)
+    {
+        fail("queued a tone that is not a digit, beep or tune");
+    }
+
+    if (duration_ms / DTMF_QUEUE_UNIT_MS > UINT8_MAX || gap_ms / DTMF_QUEUE_UNIT_MS > UINT8_MAX)
+        fail("queued a tone longer than the queue can hold");
+
+    if (_g_tone_count < MAX_TONES)
+        _g_tones[_g_tone_count++] = digit;
+
+    if (!dtmf_queue_tone(digit, duration_ms, gap_ms))
+        fail("tone queue full, tone dropped");
+
+    return true;
+}
+
+bool fuzz_queue_number(const uint8_t *packed, uint16_t duration_ms, uint16_t gap_ms)
+{
+    if (duration_ms / DTMF_QUEUE_UNIT_MS > UINT8_MAX || gap_ms / DTMF_QUEUE_UNIT_MS > UINT8_MAX)
+        fail("queued a number with tones longer than the queue can hold");
+
+    for (uint8_t i = 0; i < DIGITS_MAX && digits_get(packed, i) != DIGIT_OFF; i++)
+    {
+        if (_g_tone_count < MAX_TONES)
+            _g_tones[_g_tone_count++] = digits_get(packed, i);
+    }
+
+    if (!dtmf_queue_number(packed, duration_ms, gap_ms))
+        fail("tone queue full or busy with a number, number dropped");
+
+    return true;
+}
+
+// Each bit of the trace UART (trace.c) is one delay loop with PB0 set:
+// rebuild the bytes from the start and stop bits
+void host_delay_loop(uint16_t count)
+{
+    bool level = bit_is_set(PORTB, PIN_PWM_OUT);
+
+    if (!(DDRB & _BV(PIN_PWM_OUT)) || (TCCR0A & (_BV(COM0A1) | _BV(COM0A0))) || TCCR1)
+        fail("trace sent with PB0 not a plain output");
+
+    if (_g_uart_loops && count != _g_uart_loops)
+        fail("trace bits of different lengths");
+
+    _g_uart_loops = count;
+
+    if (!_g_uart_bits && level)
+        return;
+
+    _g_uart_byte |= (uint16_t)level << _g_uart_bits;
+
+    if (++_g_uart_bits < 10)
+        return;
+
+    if (!(_g_uart_byte & 0x200))
+        fail("trace byte without a stop bit");
+
+    if (_g_dump_len < MAX_DUMP)
+        _g_dump[_g_dump_len++] = _g_uart_byte >> 1;
+
+    _g_uart_bits = 0;
+    _g_uart_byte = 0;
+}
+
+#if defined(TRACE_RING) && defined(TRACE_UART)
+// The frame described in trace.h
+static void check_dump(bool requested)
+{
+    uint8_t check = 0;
+    int count;
+
+    if (_g_uart_bits)
+        fail("trace dump ended mid byte");
+
+    if (_g_dump_len < 6 || memcmp(_g_dump, TRACE_MAGIC, 2))
+        fail("trace dump doesn't start with the magic");
+
+    count = _g_dump[2];
+
+    if (count > TRACE_SIZE || _g_dump_len != 5 + 4 * count + 1)
+        fail("trace dump length doesn't match its count");
+
+    if ((_g_dump[3] | (_g_dump[4] << 8)) != F_CPU / 256)
+        fail("trace dump has the wrong tick rate");
+
+    for (int i = 2; i < _g_dump_len; i++)
+        check ^= _g_dump[i];
+
+    if (check)
+        fail("trace dump checksum wrong");
+
+    for (int i = 0; i < count; i++)
+    {
+        uint8_t event = _g_dump[5 + 4 * i + 2];
+
+        if (!event || event >= TR_COUNT)
+            fail("trace dump holds an unknown event");
+    }
+
+    // Dialing 2 in L2 asked for it, so that transition must be in there
+    if (requested)
+    {
+        int i = count - 1;
+
+        while (i >= 0 && (_g_dump[5 + 4 * i + 2] != TR_STATE || _g_dump[5 + 4 * i + 3] != ((2 << 4) | STATE_DIAL)))
+            i--;
+
+        if (i < 0)
+            fail("trace dump misses the L2-2 that asked for it");
+    }
+}
+
+static void dump_trace(bool requested)
+{
+    _g_dump_len = 0;
+    trace_dump();
+    check_dump(requested);
+}
+
+void fuzz_trace_dump(void)
+{
+    dump_trace(true);
+}
+#endif
+
+static void run_scenario(void)
+{
+    PINB = _g_sc.pinb;
+    _g_next_input = 0;
+    _g_now_us = 0;
+    _g_tone_count = 0;
+    _g_first_pulse_us = 0;
+    _g_first_tone_us = 0;
+
+    if (!setjmp(_g_done))
+        firmware_main();
+
+    if (_g_sc.exact)
+    {
+        uint8_t redial[DIGITS_PACKED_SIZE];
+
+        for (int i = 0; i < _g_tone_count; i++)
+        {
+            if (i >= _g_sc.tone_count || _g_tones[i] != _g_sc.tones[i])
+                fail("clean digits played back wrong");
+        }
+
+        if (_g_tone_count != _g_sc.tone_count)
+            fail("clean digits missing");
+
+        redial_load(redial);
+
+        // Speed dialing rewrites the redial staging, not checked here
+        for (int i = 0; i < DIGITS_MAX && !_g_sc.played_back; i++)
+        {
+            int8_t expected = i < _g_sc.expected_count ? _g_sc.expected[i] : DIGIT_OFF;
+
+            if (digits_get(redial, i) != expected)
+                fail("redial memory doesn't hold the digits dialed");
+        }
+
+        if (_g_sc.position >= 0)
+        {
+            uint8_t number[DIGITS_PACKED_SIZE];
+
+            eeprom_read_block(number, _g_speed_dial_eeprom[pgm_read_byte(&_g_speed_dial_loc[_g_sc.position])], DIGITS_PACKED_SIZE);
+
+            for (int i = 0; i < DIGITS_MAX; i++)
+            {
+                int8_t expected = i < _g_sc.program_count ? _g_sc.program[i] : DIGIT_OFF;
+
+                if (digits_get(number, i) != expected)
+                    fail("speed dial position doesn't hold the number programmed");
+            }
+        }
+    }
+}
+
+static void print_scenario(void)
+{
+    printf("%s scenario, %d inputs, %u ms\n", _g_sc.exact ? "Clean" : "Mixed", _g_sc.count, _g_sc.end_us / 1000);
+
+    for (int i = 0; i < _g_sc.count; i++)
+    {
+        printf("%10.3f %s %d\n", _g_sc.inputs[i].us / 1000.0,
+            _g_sc.inputs[i].pin == PIN_DIAL ? "dial " : "pulse", _g_sc.inputs[i].level);
+    }
+}
+
+// -b: every first break in turn, each in its own process that passes its
+// times back through a pipe
+static int boot_sweep(void)
+{
+    uint32_t ready_ms = 0;
+    uint32_t first_pulse_us = UINT32_MAX;
+    uint32_t worst_accept_us = 0;
+    uint32_t first_tone_us = UINT32_MAX;
+    int digits = 0;
+    int lost = 0;
+
+    for (uint32_t ms = 0; ms <= BOOT_SWEEP_MS; ms += BOOT_STEP_MS)
+    {
+        boot_result_t result;
+        int pipes[2];
+        pid_t pid;
+        int status;
+
+        generate_seed(ms);
+
+        if (pipe(pipes))
+            return 2;
+
+        pid = fork();
+
+        if (pid == 0)
+        {
+            alarm(HANG_SECONDS);
+            run_scenario();
+
+            result.first_break_us = ms * 1000;
+            result.first_pulse_us = _g_first_pulse_us;
+            result.first_tone_us = _g_first_tone_us;
+
+            if (write(pipes[1], &result, sizeof(result)) != sizeof(result))
+                _exit(2);
+
+            _exit(0);
+        }
+
+        close(pipes[1]);
+        digits++;
+
+        if (read(pipes[0], &result, sizeof(result)) != sizeof(result))
+        {
+            // Lost or wrong: the digit is only ready from the next one on
+            lost++;
+            ready_ms = ms + BOOT_STEP_MS;
+        }
+        else
+        {
+            if (result.first_pulse_us < first_pulse_us)
+                first_pulse_us = result.first_pulse_us;
+
+            if (result.first_pulse_us - result.first_break_us > worst_accept_us)
+                worst_accept_us = result.first_pulse_us - result.first_break_us;
+
+            if (result.first_tone_us < first_tone_us)
+                first_tone_us = result.first_tone_us;
+        }
+
+        close(pipes[0]);
+        waitpid(pid, &status, 0);
+    }
+
+    printf("Cold start: %d digits with their first break 0-%d ms after reset, %d lost\n",
+        digits, BOOT_SWEEP_MS, lost);
+
+    if (ready_ms > BOOT_SWEEP_MS)
+    {
+        printf("Never ready\n");
+        return 1;
+    }
+
+    printf("Boot to ready: %u ms (first breaks from then on are all counted)\n", ready_ms);
+    printf("Reset to first pulse accepted: %.1f ms, worst %.1f ms after its break\n",
+        first_pulse_us / 1000.0, worst_accept_us / 1000.0);
+    printf("Reset to first tone: %.1f ms (tones held %d ms)\n", first_tone_us / 1000.0, DTMF_SUPPLY_SETTLE_MS);
+
+    return lost ? 1 : 0;
+}
+
+// Run the scenarios of one worker, each in its own process
+static int worker(uint32_t first, uint32_t step, long count, time_t until, long *runs, double *sim_s)
+{
+    int failures = 0;
+
+    for (uint32_t seed = first; (count < 0 || *runs < count) && (!until || time(NULL) < until); seed += step)
+    {
+        pid_t pid;
+        int status;
+
+        generate_seed(seed);
+
+        pid = fork();
+
+        if (pid == 0)
+        {
+            // A firmware loop that never sleeps never advances simulated time
+            alarm(HANG_SECONDS);
+            run_scenario();
+            _exit(0);
+        }
+
+        waitpid(pid, &status, 0);
+
+        if (!WIFEXITED(status) || WEXITSTATUS(status))
+        {
+            if (WIFSIGNALED(status) && WTERMSIG(status) == SIGALRM)
+                fprintf(stderr, "seed %u: hung without sleeping\n", seed);
+            else if (WIFSIGNALED(status))
+                fprintf(stderr, "seed %u: killed by signal %d\n", seed, WTERMSIG(status));
+
+            failures++;
+        }
+
+        (*runs)++;
+        *sim_s += _g_sc.end_us / 1e6;
+    }
+
+    return failures;
+}
+
+int main(int argc, char **argv)
+{
+    long scenarios = DEFAULT_SCENARIOS;
+    int seconds = 0;
+    int jobs = sysconf(_SC_NPROCESSORS_ONLN);
+    long seed = -1;
+    int pipes[2];
+    int failures = 0;
+    long runs = 0;
+    double sim_s = 0;
+    struct timespec start, end;
+    const char *trace_file = NULL;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:t:j:s:vT:b")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n':
+                scenarios = atol(optarg);
+                break;
+            case 't':
+                seconds = atoi(optarg);
+                scenarios = -1;
+                break;
+            case 'j':
+                jobs = atoi(optarg);
+                break;
+            case 's':
+                seed = atol(optarg);
+                break;
+            case 'v':
+                _g_verbose = true;
+                break;
+            case 'T':
+                trace_file = optarg;
+                break;
+            case 'b':
+                _g_boot = true;
+                break;
+            default:
+                fprintf(stderr, "Usage: dialfuzz [-n scenarios] [-t seconds] [-j jobs] [-s seed [-v] [-T file]]\n"
+                    "       dialfuzz -b [-s first_break_ms [-v]]\n");
+                return 2;
+        }
+    }
+
+    if (seed >= 0)
+    {
+        // One scenario in the foreground
+        generate_seed(seed);
+
+        if (_g_verbose)
+            print_scenario();
+
+        run_scenario();
+
+        if (_g_verbose)
+            print_tones();
+
+        if (trace_file)
+        {
+#if defined(TRACE_RING) && defined(TRACE_UART)
+            FILE *f = fopen(trace_file, "wb");
+
+            dump_trace(false);
+
+            if (!f || fwrite(_g_dump, 1, _g_dump_len, f) != (size_t)_g_dump_len || fclose(f))
+            {
+                perror(trace_file);
+                return 2;
+            }
+
+            printf("%d bytes of trace written to %s\n", _g_dump_len, trace_file);
+#else
+            fprintf(stderr, "-T needs a build with -DTRACE_RING -DTRACE_UART (dialfuzz-trace)\n");
+            return 2;
+#endif
+        }
+
+        printf("seed %ld passed, %u.%03u s simulated, %u wake ups from idle\n", seed, _g_now_us / 1000000,
+            _g_now_us / 1000 % 1000, _g_wakeups);
+
+        if (_g_boot)
+            printf("first pulse accepted at %.1f ms, first tone at %.1f ms\n", _g_first_pulse_us / 1000.0,
+                _g_first_tone_us / 1000.0);
+
+        return 0;
+    }
+
+    if (_g_boot)
+        return boot_sweep();
+
+    if (jobs < 1)
+        jobs = 1;
+
+    if (pipe(pipes))
+        return 2;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    fflush(stdout);
+
+    for (int j = 0; j < jobs; j++)
+    {
+        if (fork() == 0)
+        {
+            long count = scenarios < 0 ? -1 : scenarios / jobs + (j < scenarios % jobs);
+            long my_runs = 0;
+            double my_sim = 0;
+            int my_failures = worker(j, jobs, count, seconds ? time(NULL) + seconds : 0, &my_runs, &my_sim);
+            char line[64];
+            int len = snprintf(line, sizeof(line), "%d %ld %f\n", my_failures, my_runs, my_sim);
+
+            // Short enough for one atomic write
+            if (write(pipes[1], line, len) != len)
+                _exit(2);
+
+            _exit(0);
+        }
+    }
+
+    close(pipes[1]);
+
+    for (int j = 0; j < jobs; j++)
+    {
+        char line[64];
+        int f;
+        long r;
+        double s;
+        int len = 0;
+
+        // One line per worker
+        while (len < (int)sizeof(line) - 1 && read(pipes[0], &line[len], 1) == 1 && line[len] != '\n')
+            len++;
+
+        line[len] = '\0';
+
+        if (sscanf(line, "%d %ld %lf", &f, &r, &s) == 3)
+        {
+            failures += f;
+            runs += r;
+            sim_s += s;
+        }
+    }
+
+    while (wait(NULL) > 0)
+        ;
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    {
+        double elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+        printf("%ld scenarios on %d jobs in %.1f s (%.0f/s), %.1f hours of dialing simulated, %d failed\n",
+            runs, jobs, elapsed, runs / elapsed, sim_s / 3600, failures);
+    }
+
+    return failures ? 1 : 0;
+}
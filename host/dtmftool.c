@@ -0,0 +1,796 @@
+//*****************************************************************************
+// Title        : Tone generator host tool
+// Author       : agent
+// Created      : 2026-10-16
+//
+// Part of the pulse to tone (DTMF) converter.
+//
+// This code is distributed under the GNU Public License
+// which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+// Host side tool for working on the tone generator without hardware.
+//
+//   dtmftool render [-d ms] [-g ms] [-u n] [-r] [-o file] sequence
+//       Plays the sequence through the tone queue (dtmf_queue_tone()) and
+//       writes the PWM duty cycle stream as a WAV file (or raw 8 bit PCM
+//       with -r) at the PWM frequency. Sequence characters are 0-9, * and #
+//       for DTMF digits, b/l for the high and low beeps and a/d for the
+//       ascending and descending tunes. -u holds every sample for n output
+//       samples like the PWM does, so images of the tones around the sample
+//       rate show up in the recording (compare clocks at the same output rate).
+//
+//   dtmftool check file.wav
+//       Splits the recording into tones and reports per tone digit,
+//       frequency error, twist and SNR.
+//
+//   dtmftool steps
+//       Lists the step widths of every digit and the frequencies they
+//       actually produce, without rendering anything.
+//
+//   dtmftool thd [-f hz]
+//       Distortion of single tones straight from the sample generator
+//       (every DTMF frequency unless -f is given), plus the table size.
+//
+//   dtmftool snr [-b hz]
+//       SNR of every digit straight from the sample generator, against all
+//       the noise up to half the sample rate and against only the noise
+//       below -b Hz (the telephone band, 3400Hz by default). Compare the
+//       in band figure with and without DDS_NOISE_SHAPE.
+//
+//   dtmftool bench [-n samples]
+//       Measures the throughput of the sample generator.
+//
+//   dtmftool carrier [-c hz] [-d digit]
+//       Spectral purity at the output pin after an RC low pass of 1 to 3
+//       poles at -c Hz: the carrier relative to the tone and the tone
+//       against everything else (carrier, images around the sample rate
+//       and table noise), for the Timer0 carrier (at the sample rate) and
+//       the Timer1 one from the 64MHz PLL (DTMF_PLL_PWM, 250kHz). Both
+//       run at the same sample rate, so only the carrier differs.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../dds.h"
+#include "../dtmf.h"
+#include "goertzel.h"
+#include "hal.h"
+
+#define DEFAULT_GAP_MS          DTMF_DURATION_MS
+#define DEFAULT_BENCH_SAMPLES   100000000UL
+#define MAX_TONES               256
+#define DEFAULT_BAND_HZ         3400
+#define CARRIER_MS              60
+#define CARRIER_SETTLE_MS       20      // filter start up, not measured
+#define CARRIER_MAX_POLES       3
+#define CARRIER_CUTOFF_HZ       3400
+#define PLL_HZ                  64000000UL
+
+typedef struct
+{
+    uint8_t *data;
+    size_t len;
+    size_t size;
+} pcm_buffer_t;
+
+static void pcm_append(uint8_t sample, void *ctx)
+{
+    pcm_buffer_t *pcm = ctx;
+
+    if (pcm->len == pcm->size)
+    {
+        pcm->size = pcm->size ? pcm->size * 2 : 65536;
+        pcm->data = realloc(pcm->data, pcm->size);
+
+        if (!pcm->data)
+        {
+            fprintf(stderr, "Out of memory\n");
+            exit(1);
+        }
+    }
+
+    pcm->data[pcm->len++] = sample;
+}
+
+static void put_le(FILE *fp, uint32_t value, int bytes)
+{
+    for (int i = 0; i < bytes; i++)
+        fputc((value >> (8 * i)) & 0xFF, fp);
+}
+
+static void write_wav(FILE *fp, const uint8_t *data, size_t len, uint32_t rate)
+{
+    fwrite("RIFF", 1, 4, fp);
+    put_le(fp, 36 + len, 4);
+    fwrite("WAVEfmt ", 1, 8, fp);
+    put_le(fp, 16, 4);      // fmt chunk size
+    put_le(fp, 1, 2);       // PCM
+    put_le(fp, 1, 2);       // Mono
+    put_le(fp, rate, 4);
+    put_le(fp, rate, 4);    // Byte rate
+    put_le(fp, 1, 2);       // Block align
+    put_le(fp, 8, 2);       // Bits per sample
+    fwrite("data", 1, 4, fp);
+    put_le(fp, len, 4);
+    fwrite(data, 1, len, fp);
+}
+
+static uint32_t get_le(const uint8_t *p, int bytes)
+{
+    uint32_t value = 0;
+
+    for (int i = bytes - 1; i >= 0; i--)
+        value = (value << 8) | p[i];
+
+    return value;
+}
+
+// Reads a mono 8 bit unsigned or 16 bit signed PCM WAV file
+static double *read_wav(const char *path, size_t *count, uint32_t *rate)
+{
+    FILE *fp = fopen(path, "rb");
+    uint8_t *file;
+    long size;
+    double *samples = NULL;
+    int bits = 0;
+
+    if (!fp)
+    {
+        perror(path);
+        return NULL;
+    }
+
+    fseek(fp, 0, SEEK_END);
+    size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    file = malloc(size);
+
+    if (!file || fread(file, 1, size, fp) != (size_t)size || size < 12 ||
+        memcmp(file, "RIFF", 4) || memcmp(file + 8, "WAVE", 4))
+    {
+        fprintf(stderr, "%s: not a WAV file\n", path);
+        goto out;
+    }
+
+    for (long pos = 12; pos + 8 <= size; )
+    {
+        uint32_t chunk_size = get_le(file + pos + 4, 4);
+        const uint8_t *chunk = file + pos + 8;
+
+        if (pos + 8 + (long)chunk_size > size)
+            break;
+
+        if (!memcmp(file + pos, "fmt ", 4) && chunk_size >= 16)
+        {
+            if (get_le(chunk, 2) != 1 || get_le(chunk + 2, 2) != 1)
+            {
+                fprintf(stderr, "%s: only mono PCM is supported\n", path);
+                goto out;
+            }
+
+            *rate = get_le(chunk + 4, 4);
+            bits = get_le(chunk + 14, 2);
+        }
+        else if (!memcmp(file + pos, "data", 4) && (bits == 8 || bits == 16))
+        {
+            *count = chunk_size / (bits / 8);
+            samples = malloc(*count * sizeof(double));
+
+            for (size_t i = 0; samples && i < *count; i++)
+            {
+                if (bits == 8)
+                    samples[i] = chunk[i];
+                else
+                    samples[i] = (int16_t)get_le(chunk + 2 * i, 2) / 256.0;
+            }
+
+            break;
+        }
+
+        pos += 8 + chunk_size + (chunk_size & 1);
+    }
+
+    if (!samples)
+        fprintf(stderr, "%s: no usable PCM data\n", path);
+
+out:
+    free(file);
+    fclose(fp);
+    return samples;
+}
+
+static int8_t sequence_digit(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+
+    switch (c)
+    {
+        case '*':
+            return DIGIT_STAR;
+        case '#':
+            return DIGIT_POUND;
+        case 'b':
+            return DIGIT_BEEP;
+        case 'l':
+            return DIGIT_BEEP_LOW;
+        case 'a':
+            return DIGIT_TUNE_ASC;
+        case 'd':
+            return DIGIT_TUNE_DESC;
+    }
+
+    return DIGIT_OFF;
+}
+
+static int cmd_render(int argc, char **argv)
+{
+    pcm_buffer_t pcm = { 0 };
+    uint16_t duration_ms = DTMF_DURATION_MS;
+    uint16_t gap_ms = DEFAULT_GAP_MS;
+    const char *out_path = NULL;
+    bool raw = false;
+    int hold = 1;
+    FILE *fp = stdout;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "d:g:o:ru:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'd':
+                duration_ms = atoi(optarg);
+                break;
+            case 'g':
+                gap_ms = atoi(optarg);
+                break;
+            case 'o':
+                out_path = optarg;
+                break;
+            case 'r':
+                raw = true;
+                break;
+            case 'u':
+                hold = atoi(optarg);
+                break;
+            default:
+                return 2;
+        }
+    }
+
+    if (optind >= argc)
+    {
+        fprintf(stderr, "render: no sequence given\n");
+        return 2;
+    }
+
+    hal_set_sample_sink(pcm_append, &pcm);
+    dtmf_init();
+
+    for (const char *s = argv[optind]; *s; s++)
+    {
+        int8_t digit = sequence_digit(*s);
+
+        if (digit == DIGIT_OFF)
+        {
+            fprintf(stderr, "render: unknown sequence character '%c'\n", *s);
+            return 2;
+        }
+
+        // Queue everything, playing out whenever it fills
+        if (!dtmf_queue_tone(digit, duration_ms, gap_ms))
+        {
+            dtmf_wait();
+            dtmf_queue_tone(digit, duration_ms, gap_ms);
+        }
+    }
+
+    dtmf_wait();
+
+    if (hold > 1)
+    {
+        pcm_buffer_t held = { 0 };
+
+        for (size_t i = 0; i < pcm.len; i++)
+        {
+            for (int j = 0; j < hold; j++)
+                pcm_append(pcm.data[i], &held);
+        }
+
+        free(pcm.data);
+        pcm = held;
+    }
+    else
+    {
+        hold = 1;
+    }
+
+    if (out_path && !(fp = fopen(out_path, "wb")))
+    {
+        perror(out_path);
+        return 1;
+    }
+
+    if (raw)
+        fwrite(pcm.data, 1, pcm.len, fp);
+    else
+        write_wav(fp, pcm.data, pcm.len, DDS_SAMPLE_RATE * hold);
+
+    if (fp != stdout)
+        fclose(fp);
+
+    free(pcm.data);
+    return 0;
+}
+
+static int cmd_check(int argc, char **argv)
+{
+    size_t count = 0;
+    uint32_t rate = 0;
+    double *x;
+    double worst_err = 0.0;
+    double worst_snr = INFINITY;
+    int tones = 0;
+
+    if (argc < 2)
+    {
+        fprintf(stderr, "check: no file given\n");
+        return 2;
+    }
+
+    if (!(x = read_wav(argv[1], &count, &rate)))
+        return 1;
+
+    printf("  #  start_ms  len_ms  digit   low_hz    err%%   high_hz    err%%  twist_db  snr_db\n");
+
+    tone_segment_t *segments = malloc(MAX_TONES * sizeof(tone_segment_t));
+    size_t found = goertzel_segment(x, count, rate, segments, MAX_TONES);
+
+    for (size_t i = 0; i < found; i++)
+    {
+        tone_analysis_t a;
+        size_t offset = segments[i].start;
+        size_t len = segments[i].len;
+
+        goertzel_analyse(x + offset, len, rate, &a);
+        tones++;
+
+        printf("%3d  %8.1f  %6.1f      %c  %7.2f  %+6.3f  %8.2f  %+6.3f  %8.2f  %6.2f\n",
+            tones, 1000.0 * offset / rate, 1000.0 * len / rate, a.digit,
+            a.freq_low, a.err_low, a.freq_high, a.err_high, a.twist_db, a.snr_db);
+
+        if (fabs(a.err_low) > worst_err)
+            worst_err = fabs(a.err_low);
+        if (fabs(a.err_high) > worst_err)
+            worst_err = fabs(a.err_high);
+        if (a.snr_db < worst_snr)
+            worst_snr = a.snr_db;
+    }
+
+    if (tones)
+        printf("%d tones, worst frequency error %.3f%%, worst SNR %.2f dB\n", tones, worst_err, worst_snr);
+    else
+        printf("No tones found\n");
+
+    free(segments);
+    free(x);
+    return 0;
+}
+
+static int cmd_bench(int argc, char **argv)
+{
+    unsigned long samples = DEFAULT_BENCH_SAMPLES;
+    struct timespec t0, t1;
+    uint32_t check = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:")) != -1)
+    {
+        if (opt == 'n')
+            samples = strtoul(optarg, NULL, 0);
+        else
+            return 2;
+    }
+
+    dds_init();
+    _g_stepwidth_a = _g_notes[8].step_a;
+    _g_stepwidth_b = _g_notes[8].step_b;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    for (unsigned long i = 0; i < samples; i++)
+        check += dds_next_sample();
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    double secs = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+
+    printf("%lu samples in %.3f s: %.1f Msamples/s, %.0fx real time (checksum %08x)\n",
+        samples, secs, samples / secs / 1e6, samples / secs / DDS_SAMPLE_RATE, check);
+
+    return 0;
+}
+
+// Power of the least squares fit of two sines at f1 and f2 to y (mean
+// already removed). Unlike a Goertzel bin this is exact whatever the
+// number of cycles in y, which matters once everything else is 60 dB down
+static double fit_tones(const double *y, size_t len, double rate, double f1, double f2)
+{
+    double a[4][5] = { { 0 } };
+    double by[4];
+    double c1 = cos(2.0 * M_PI * f1 / rate);
+    double s1 = sin(2.0 * M_PI * f1 / rate);
+    double c2 = cos(2.0 * M_PI * f2 / rate);
+    double s2 = sin(2.0 * M_PI * f2 / rate);
+    double p1[2] = { 1.0, 0.0 };
+    double p2[2] = { 1.0, 0.0 };
+    double explained = 0.0;
+
+    // Normal equations, the basis from two rotating phasors
+    for (size_t i = 0; i < len; i++)
+    {
+        double b[4] = { p1[0], p1[1], p2[0], p2[1] };
+        double t;
+
+        for (int r = 0; r < 4; r++)
+        {
+            for (int c = 0; c < 4; c++)
+                a[r][c] += b[r] * b[c];
+
+            a[r][4] += b[r] * y[i];
+        }
+
+        t = p1[0] * c1 - p1[1] * s1;
+        p1[1] = p1[0] * s1 + p1[1] * c1;
+        p1[0] = t;
+        t = p2[0] * c2 - p2[1] * s2;
+        p2[1] = p2[0] * s2 + p2[1] * c2;
+        p2[0] = t;
+    }
+
+    for (int r = 0; r < 4; r++)
+        by[r] = a[r][4];
+
+    // Gauss-Jordan, the matrix is close to diagonal
+    for (int r = 0; r < 4; r++)
+    {
+        for (int o = 0; o < 4; o++)
+        {
+            double f = a[o][r] / a[r][r];
+
+            if (o == r)
+                continue;
+
+            for (int c = r; c < 5; c++)
+                a[o][c] -= f * a[r][c];
+        }
+    }
+
+    // Explained sum of squares: coefficients . (basis . y)
+    for (int r = 0; r < 4; r++)
+        explained += a[r][4] / a[r][r] * by[r];
+
+    return explained / len;
+}
+
+// Runs the PWM waveform for the samples, periods carrier periods of 256
+// clocks per sample, through poles RC sections at cutoff Hz and returns
+// the carrier and everything but the tone relative to the tone, in dB
+static void carrier_filter(const uint8_t *samples, size_t n, int periods, int poles, double cutoff,
+    double f_low, double f_high, double *carrier_db, double *snr_db)
+{
+    size_t steps = 256 * periods;
+    double rate = (double)DDS_SAMPLE_RATE * steps;
+    double alpha = 1.0 - exp(-2.0 * M_PI * cutoff / rate);
+    size_t settle = (size_t)DDS_SAMPLE_RATE * CARRIER_SETTLE_MS / 1000 * steps;
+    size_t len = n * steps - settle;
+    double *y = malloc(len * sizeof(double));
+    double stage[CARRIER_MAX_POLES] = { 0 };
+    double mean = 0.0;
+    double total = 0.0;
+    double tone;
+    double carrier;
+    size_t k = 0;
+
+    if (!y)
+    {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+
+    for (size_t i = 0; i < n; i++)
+    {
+        for (size_t c = 0; c < steps; c++)
+        {
+            double x = (c & 0xFF) < samples[i] ? 1.0 : 0.0;
+
+            for (int s = 0; s < poles; s++)
+                x = stage[s] += alpha * (x - stage[s]);
+
+            if (k >= settle)
+                y[k - settle] = x;
+
+            k++;
+        }
+    }
+
+    for (size_t i = 0; i < len; i++)
+        mean += y[i];
+
+    mean /= len;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        y[i] -= mean;
+        total += y[i] * y[i];
+    }
+
+    // A whole number of carrier periods, so its Goertzel bin is exact:
+    // the power of a sine at the bin is (amplitude * len / 2)^2
+    tone = fit_tones(y, len, rate, f_low, f_high);
+    carrier = 2.0 * goertzel_power(y, len, (double)DDS_SAMPLE_RATE * periods, rate) / len / len;
+    total /= len;
+
+    *carrier_db = 10.0 * log10(carrier / tone);
+    *snr_db = 10.0 * log10(tone / (total - tone));
+
+    free(y);
+}
+
+static int cmd_carrier(int argc, char **argv)
+{
+    static const char names[] = "0123456789*#";
+    static const struct
+    {
+        const char *name;
+        int periods;
+    } engines[] =
+    {
+        { "timer0", 1 },
+        { "pll", PLL_HZ / F_CPU },
+    };
+    double cutoff = CARRIER_CUTOFF_HZ;
+    int digit = 8;
+    size_t n = (size_t)DDS_SAMPLE_RATE * CARRIER_MS / 1000;
+    uint8_t *samples = malloc(n);
+    double f_low;
+    double f_high;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "c:d:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'c':
+                cutoff = atof(optarg);
+                break;
+            case 'd':
+                if (!strchr(names, optarg[0]))
+                    return 2;
+                digit = strchr(names, optarg[0]) - names;
+                break;
+            default:
+                return 2;
+        }
+    }
+
+    dds_init();
+    _g_stepwidth_a = _g_notes[digit].step_a;
+    _g_stepwidth_b = _g_notes[digit].step_b;
+    f_high = (double)_g_stepwidth_a * DDS_SAMPLE_RATE / 65536.0;
+    f_low = (double)_g_stepwidth_b * DDS_SAMPLE_RATE / 65536.0;
+
+    for (size_t i = 0; i < n; i++)
+        samples[i] = dds_next_sample();
+
+    printf("Digit %c, RC low pass at %.0f Hz\n", names[digit], cutoff);
+    printf("engine  carrier_hz  poles  carrier_db  snr_db\n");
+
+    for (size_t e = 0; e < sizeof(engines) / sizeof(engines[0]); e++)
+    {
+        for (int poles = 1; poles <= CARRIER_MAX_POLES; poles++)
+        {
+            double carrier_db;
+            double snr_db;
+
+            carrier_filter(samples, n, engines[e].periods, poles, cutoff, f_low, f_high, &carrier_db, &snr_db);
+            printf("%-6s  %10lu  %5d  %10.1f  %6.1f\n", engines[e].name,
+                (unsigned long)DDS_SAMPLE_RATE * engines[e].periods, poles, carrier_db, snr_db);
+        }
+    }
+
+    free(samples);
+    return 0;
+}
+
+static int cmd_steps(int argc, char **argv)
+{
+    // Nominal frequencies of the digit notes (_g_notes[]), high group first
+    static const uint16_t nominal[12][2] =
+    {
+        { 1336, 941 }, { 1209, 697 }, { 1336, 697 }, { 1477, 697 },
+        { 1209, 770 }, { 1336, 770 }, { 1477, 770 }, { 1209, 852 },
+        { 1336, 852 }, { 1477, 852 }, { 1209, 941 }, { 1477, 941 },
+    };
+    static const char names[] = "0123456789*#";
+    double worst = 0.0;
+
+    printf("digit  high_step  high_hz     err%%  low_step   low_hz     err%%\n");
+
+    for (int d = 0; d < 12; d++)
+    {
+        uint16_t steps[2] = { _g_notes[d].step_a, _g_notes[d].step_b };
+
+        printf("    %c", names[d]);
+
+        for (int i = 0; i < 2; i++)
+        {
+            double actual = (double)steps[i] * DDS_SAMPLE_RATE / 65536.0;
+            double err = 100.0 * (actual - nominal[d][i]) / nominal[d][i];
+
+            printf("  %9u  %7.2f  %+7.3f", steps[i], actual, err);
+
+            if (fabs(err) > worst)
+                worst = fabs(err);
+        }
+
+        printf("\n");
+    }
+
+    printf("Sample rate %lu Hz, worst error %.3f%%\n", (unsigned long)DDS_SAMPLE_RATE, worst);
+    return 0;
+}
+
+static int cmd_thd(int argc, char **argv)
+{
+    static const double dtmf_freqs[] = { 697, 770, 852, 941, 1209, 1336, 1477, 1633 };
+    const double *freqs = dtmf_freqs;
+    int num_freqs = sizeof(dtmf_freqs) / sizeof(dtmf_freqs[0]);
+    size_t n = DDS_SAMPLE_RATE;
+    double *x = malloc(n * sizeof(double));
+    double single;
+    double worst_thd = -INFINITY;
+    double worst_thdn = -INFINITY;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "f:")) != -1)
+    {
+        if (opt != 'f')
+            return 2;
+
+        single = atof(optarg);
+        freqs = &single;
+        num_freqs = 1;
+    }
+
+    printf("Sine table %u entries (%u bytes), %u samples per period\n",
+        (unsigned)DDS_TABLE_SIZE, (unsigned)sizeof(auc_sin_param), (unsigned)NUM_SAMPLES);
+    printf("    freq_hz  thd_db  thdn_db\n");
+
+    for (int i = 0; i < num_freqs; i++)
+    {
+        uint16_t step = DDS_FREQ(freqs[i]);
+        double thd;
+        double thdn;
+
+        dds_init();
+        _g_stepwidth_a = step;
+
+        for (size_t j = 0; j < n; j++)
+            x[j] = dds_next_sample();
+
+        // Measure at the frequency actually produced, not the nominal one
+        goertzel_thd(x, n, DDS_SAMPLE_RATE, (double)step * DDS_SAMPLE_RATE / 65536.0, &thd, &thdn);
+        printf("%11.2f  %6.2f  %7.2f\n", freqs[i], thd, thdn);
+
+        if (thd > worst_thd)
+            worst_thd = thd;
+        if (thdn > worst_thdn)
+            worst_thdn = thdn;
+    }
+
+    printf("Worst THD %.2f dB, worst THD+N %.2f dB\n", worst_thd, worst_thdn);
+    free(x);
+    return 0;
+}
+
+static int cmd_snr(int argc, char **argv)
+{
+    static const char digits[] = "0123456789*#";
+    size_t n = DDS_SAMPLE_RATE / 4;
+    double *x = malloc(n * sizeof(double));
+    double band = DEFAULT_BAND_HZ;
+    double worst_snr = INFINITY;
+    double worst_band = INFINITY;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "b:")) != -1)
+    {
+        if (opt != 'b')
+            return 2;
+
+        band = atof(optarg);
+    }
+
+#ifdef DDS_NOISE_SHAPE
+    printf("Noise shaping on, %d bit sine table, %d bits fed back\n", DDS_SIN_BITS, DDS_NS_BITS);
+#else
+    printf("Noise shaping off, %d bit sine table\n", DDS_SIN_BITS);
+#endif
+    printf("digit   low_hz  high_hz  snr_db  band_db\n");
+
+    for (int d = 0; d < 12; d++)
+    {
+        double f_high = (double)_g_notes[d].step_a * DDS_SAMPLE_RATE / 65536.0;
+        double f_low = (double)_g_notes[d].step_b * DDS_SAMPLE_RATE / 65536.0;
+        tone_analysis_t a;
+        double band_snr;
+
+        dds_init();
+        _g_stepwidth_a = _g_notes[d].step_a;
+        _g_stepwidth_b = _g_notes[d].step_b;
+
+        for (size_t i = 0; i < n; i++)
+            x[i] = dds_next_sample();
+
+        goertzel_analyse(x, n, DDS_SAMPLE_RATE, &a);
+        band_snr = goertzel_band_snr(x, n, DDS_SAMPLE_RATE, f_low, f_high, band);
+        printf("    %c  %7.2f  %7.2f  %6.2f  %7.2f\n", digits[d], f_low, f_high, a.snr_db, band_snr);
+
+        if (a.snr_db < worst_snr)
+            worst_snr = a.snr_db;
+        if (band_snr < worst_band)
+            worst_band = band_snr;
+    }
+
+    printf("Worst SNR %.2f dB, worst below %.0f Hz %.2f dB\n", worst_snr, band, worst_band);
+    free(x);
+    return 0;
+}
+
+static void usage(void)
+{
+    fprintf(stderr,
+        "Usage: dtmftool render [-d ms] [-g ms] [-u n] [-r] [-o file] sequence\n"
+        "       dtmftool check file.wav\n"
+        "       dtmftool steps\n"
+        "       dtmftool thd [-f hz]\n"
+        "       dtmftool snr [-b hz]\n"
+        "       dtmftool bench [-n samples]\n"
+        "       dtmftool carrier [-c hz] [-d digit]\n");
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        usage();
+        return 2;
+    }
+
+    if (!strcmp(argv[1], "render"))
+        return cmd_render(argc - 1, argv + 1);
+    if (!strcmp(argv[1], "check"))
+        return cmd_check(argc - 1, argv + 1);
+    if (!strcmp(argv[1], "steps"))
+        return cmd_steps(argc - 1, argv + 1);
+    if (!strcmp(argv[1], "thd"))
+        return cmd_thd(argc - 1, argv + 1);
+    if (!strcmp(argv[1], "snr"))
+        return cmd_snr(argc - 1, argv + 1);
+    if (!strcmp(argv[1], "bench"))
+        return cmd_bench(argc - 1, argv + 1);
+    if (!strcmp(argv[1], "carrier"))
+        return cmd_carrier(argc - 1, argv + 1);
+
+    usage();
+    return 2;
+}
@@ -0,0 +1,71 @@
+//*****************************************************************************
+// Title        : Host EEPROM model
+// Author       : agent
+// Created      : 2026-10-16
+//
+// Part of the pulse to tone (DTMF) converter.
+//
+// This code is distributed under the GNU Public License
+// which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+// Host EEPROM: the EEMEM variables themselves (section "eeprom") are the
+// cells. Every byte actually written is counted per cell, and writes can be
+// made to stop part way to model losing power during an update.
+
+#include <stdint.h>
+#include <string.h>
+#include <avr/eeprom.h>
+
+#define EEPROM_SIZE             1024        // ATtiny85 has 512, plus host alignment padding
+
+extern uint8_t __start_eeprom[];
+extern uint8_t __stop_eeprom[];
+
+static uint32_t _g_writes[EEPROM_SIZE];
+static int32_t _g_writes_left = -1;         // -1: no power loss pending
+
+uint8_t eeprom_read_byte(const uint8_t *p)
+{
+    return *p;
+}
+
+void eeprom_read_block(void *dst, const void *src, size_t n)
+{
+    memcpy(dst, src, n);
+}
+
+void eeprom_update_byte(uint8_t *p, uint8_t value)
+{
+    if (*p == value || _g_writes_left == 0)
+        return;
+
+    if (_g_writes_left > 0)
+        _g_writes_left--;
+
+    *p = value;
+    _g_writes[p - __start_eeprom]++;
+}
+
+void eeprom_update_block(const void *src, void *dst, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+        eeprom_update_byte((uint8_t *)dst + i, ((const uint8_t *)src)[i]);
+}
+
+uint32_t host_eeprom_size(void)
+{
+    return __stop_eeprom - __start_eeprom;
+}
+
+uint32_t host_eeprom_writes(const void *p)
+{
+    return _g_writes[(const uint8_t *)p - __start_eeprom];
+}
+
+// Ignore every write after the next n (power lost); -1 powers back up
+void host_eeprom_fail_after(int32_t writes)
+{
+    _g_writes_left = writes;
+}
@@ -0,0 +1,217 @@
+//*****************************************************************************
+// Title        : Redial log EEPROM wear projection
+// Author       : agent
+// Created      : 2026-10-16
+//
+// Part of the pulse to tone (DTMF) converter.
+//
+// This code is distributed under the GNU Public License
+// which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+// Projects how long the redial memory lasts. Plays a number of calls
+// through the real redial log (../redial.c) on the host EEPROM and,
+// for comparison, through a single fixed block updated in place as the
+// firmware used to, then reports the most written cell of each.
+//
+//   eewear [-n calls] [-b numbers] [-p] [-s seed]
+//
+// Calls dial numbers picked at random from an address book of -b entries
+// (default 20); every save is read back, along with the number before it
+// from the history. -p also cuts the power at a random point of every fifth
+// save and checks the redial number is then either the old or the new one.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <avr/eeprom.h>
+
+#include "../digits.h"
+#include "../redial.h"
+
+#define DEFAULT_CALLS           100000
+#define DEFAULT_NUMBERS         20
+#define CELL_ENDURANCE          100000  // ATtiny85 data sheet, write/erase cycles
+
+extern uint8_t __start_eeprom[];
+extern uint8_t __stop_eeprom[];
+
+// The old layout: one unpacked digit per byte, updated in place
+static int8_t EEMEM _g_fixed_eeprom[DIGITS_MAX];
+
+static const int _g_calls_per_day[] = { 10, 50, 200, 1000 };
+
+static void random_number(uint8_t *packed)
+{
+    int len = 7 + rand() % 8;
+
+    memset(packed, DIGITS_PACKED_EMPTY, DIGITS_PACKED_SIZE);
+
+    for (int i = 0; i < len; i++)
+        digits_set(packed, i, rand() % 10);
+}
+
+static void unpack(const uint8_t *packed, int8_t *digits)
+{
+    for (int i = 0; i < DIGITS_MAX; i++)
+        digits[i] = digits_get(packed, i);
+}
+
+static uint32_t max_writes(const uint8_t *from, const uint8_t *to)
+{
+    uint32_t max = 0;
+
+    for (const uint8_t *p = from; p < to; p++)
+    {
+        if (host_eeprom_writes(p) > max)
+            max = host_eeprom_writes(p);
+    }
+
+    return max;
+}
+
+static void report(const char *name, uint32_t writes, long calls)
+{
+    double per_call = (double)writes / calls;
+
+    printf("%-12s %8u %12.4f", name, writes, per_call);
+
+    for (size_t i = 0; i < sizeof(_g_calls_per_day) / sizeof(_g_calls_per_day[0]); i++)
+        printf(" %10.1f", CELL_ENDURANCE / (per_call * _g_calls_per_day[i]) / 365.0);
+
+    printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+    long calls = DEFAULT_CALLS;
+    int numbers = DEFAULT_NUMBERS;
+    bool power_loss = false;
+    uint8_t (*book)[DIGITS_PACKED_SIZE];
+    uint8_t current[DIGITS_PACKED_SIZE];
+    uint8_t loaded[DIGITS_PACKED_SIZE];
+    int8_t unpacked[DIGITS_MAX];
+    long torn = 0;
+    int opt;
+
+    srand(1);
+
+    while ((opt = getopt(argc, argv, "n:b:ps:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n':
+                calls = atol(optarg);
+                break;
+            case 'b':
+                numbers = atoi(optarg);
+                break;
+            case 'p':
+                power_loss = true;
+                break;
+            case 's':
+                srand(atoi(optarg));
+                break;
+            default:
+                fprintf(stderr, "Usage: eewear [-n calls] [-b numbers] [-p] [-s seed]\n");
+                return 2;
+        }
+    }
+
+    if (calls <= 0 || numbers <= 0)
+        return 2;
+
+    book = malloc(numbers * sizeof(*book));
+
+    for (int i = 0; i < numbers; i++)
+        random_number(book[i]);
+
+    redial_init();
+    redial_load(current);
+
+    for (long c = 0; c < calls; c++)
+    {
+        const uint8_t *digits = book[rand() % numbers];
+
+        unpack(digits, unpacked);
+        eeprom_update_block(unpacked, _g_fixed_eeprom, DIGITS_MAX);
+
+        if (power_loss && c % 5 == 0)
+        {
+            // Lose power somewhere inside the save, then start up again
+            host_eeprom_fail_after(rand() % (DIGITS_PACKED_SIZE + 2));
+            redial_save(digits);
+            host_eeprom_fail_after(-1);
+            redial_init();
+            redial_load(loaded);
+
+            if (memcmp(loaded, current, DIGITS_PACKED_SIZE) && memcmp(loaded, digits, DIGITS_PACKED_SIZE))
+            {
+                fprintf(stderr, "Call %ld: redial number corrupted by power loss\n", c);
+                return 1;
+            }
+
+            if (memcmp(loaded, digits, DIGITS_PACKED_SIZE))
+                torn++;
+
+            memcpy(current, loaded, DIGITS_PACKED_SIZE);
+            continue;
+        }
+
+        redial_save(digits);
+        redial_load(loaded);
+
+        if (memcmp(loaded, digits, DIGITS_PACKED_SIZE))
+        {
+            fprintf(stderr, "Call %ld: redial number read back wrong\n", c);
+            return 1;
+        }
+
+        // The number before is next in the history
+        if (memcmp(current, digits, DIGITS_PACKED_SIZE) && digits_get(current, 0) != DIGIT_OFF &&
+            (!redial_load_nth(1, loaded) || memcmp(loaded, current, DIGITS_PACKED_SIZE)))
+        {
+            fprintf(stderr, "Call %ld: history out of order\n", c);
+            return 1;
+        }
+
+        memcpy(current, digits, DIGITS_PACKED_SIZE);
+    }
+
+    printf("%ld calls, %d numbers, %d log records, %u byte cells endurance\n",
+        calls, numbers, REDIAL_LOG_RECORDS, CELL_ENDURANCE);
+
+    if (power_loss)
+        printf("Power lost in %ld saves, %ld kept the previous number, none corrupted\n", (calls + 4) / 5, torn);
+
+    printf("%-12s %8s %12s", "storage", "max_wr", "wr/call");
+
+    for (size_t i = 0; i < sizeof(_g_calls_per_day) / sizeof(_g_calls_per_day[0]); i++)
+        printf("  yrs@%4d/d", _g_calls_per_day[i]);
+
+    printf("\n");
+
+    report("fixed block", max_writes((uint8_t *)_g_fixed_eeprom, (uint8_t *)_g_fixed_eeprom + DIGITS_MAX), calls);
+
+    // Everything else in the section is the redial log
+    uint32_t log_max = 0;
+
+    if ((uint8_t *)_g_fixed_eeprom > __start_eeprom)
+        log_max = max_writes(__start_eeprom, (uint8_t *)_g_fixed_eeprom);
+    if ((uint8_t *)_g_fixed_eeprom + DIGITS_MAX < __stop_eeprom)
+    {
+        uint32_t after = max_writes((uint8_t *)_g_fixed_eeprom + DIGITS_MAX, __stop_eeprom);
+
+        if (after > log_max)
+            log_max = after;
+    }
+
+    report("redial log", log_max, calls);
+
+    free(book);
+    return 0;
+}
@@ -0,0 +1,361 @@
+//*****************************************************************************
+// Title        : Goertzel DTMF analysis
+// Author       : agent
+// Created      : 2026-10-16
+//
+// Part of the pulse to tone (DTMF) converter.
+//
+// This code is distributed under the GNU Public License
+// which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+// Goertzel based DTMF analysis for the host tools. Frequencies are
+// measured by searching for the peak of the windowed spectrum rather than
+// just testing the eight nominal frequencies, so the DDS rounding error
+// shows up in the results.
+
+#include <stdbool.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "goertzel.h"
+
+#define SCAN_LOW_HZ         300.0
+#define SCAN_HIGH_HZ        1800.0
+#define SCAN_STEP_HZ        2.0
+#define REFINE_STEP_HZ      0.01
+#define MIN_SEPARATION_HZ   100.0
+#define SECOND_TONE_DB      20.0
+#define MATCH_TOLERANCE     0.05
+#define BLOCK_SAMPLES       64
+#define BLOCK_VARIANCE_MIN  1.0
+#define MIN_TONE_MS         20
+
+static const double _g_low_group[4] = { 697, 770, 852, 941 };
+static const double _g_high_group[4] = { 1209, 1336, 1477, 1633 };
+static const char _g_keypad[4][4] =
+{
+    { '1', '2', '3', 'A' },
+    { '4', '5', '6', 'B' },
+    { '7', '8', '9', 'C' },
+    { '*', '0', '#', 'D' },
+};
+
+// |X(f)|^2 of x[0..n) at an arbitrary (non bin centred) frequency
+double goertzel_power(const double *x, size_t n, double freq, double rate)
+{
+    double coeff = 2.0 * cos(2.0 * M_PI * freq / rate);
+    double s1 = 0.0;
+    double s2 = 0.0;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        double s0 = x[i] + coeff * s1 - s2;
+        s2 = s1;
+        s1 = s0;
+    }
+
+    return s1 * s1 + s2 * s2 - coeff * s1 * s2;
+}
+
+static double refine_peak(const double *x, size_t n, double freq, double rate, double *power)
+{
+    double best = freq;
+    double best_power = 0.0;
+
+    for (double f = freq - SCAN_STEP_HZ; f <= freq + SCAN_STEP_HZ; f += REFINE_STEP_HZ)
+    {
+        double p = goertzel_power(x, n, f, rate);
+
+        if (p > best_power)
+        {
+            best_power = p;
+            best = f;
+        }
+    }
+
+    *power = best_power;
+    return best;
+}
+
+static int nearest(const double *group, double freq)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        if (fabs(freq - group[i]) <= group[i] * MATCH_TOLERANCE)
+            return i;
+    }
+
+    return -1;
+}
+
+// Least squares fit of DC plus sines at the measured frequencies (freq2 = 0
+// fits a single tone). Returns the residual power, i.e. everything that is
+// not one of the tones, and the power of each tone. The residual itself is
+// stored in resid unless it is NULL
+static double fit_tones(const double *x, size_t n, double rate, double freq1, double freq2,
+    double *power1, double *power2, double *resid)
+{
+    int terms = freq2 > 0.0 ? 5 : 3;
+    double ata[5][6] = { { 0 } };
+    double coef[5];
+    double basis[5];
+    double residual = 0.0;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        basis[0] = 1.0;
+        basis[1] = cos(2.0 * M_PI * freq1 * i / rate);
+        basis[2] = sin(2.0 * M_PI * freq1 * i / rate);
+        basis[3] = cos(2.0 * M_PI * freq2 * i / rate);
+        basis[4] = sin(2.0 * M_PI * freq2 * i / rate);
+
+        for (int r = 0; r < terms; r++)
+        {
+            for (int c = 0; c < terms; c++)
+                ata[r][c] += basis[r] * basis[c];
+
+            ata[r][terms] += basis[r] * x[i];
+        }
+    }
+
+    // Gaussian elimination, the normal equations are well conditioned
+    for (int r = 0; r < terms; r++)
+    {
+        for (int k = r + 1; k < terms; k++)
+        {
+            double m = ata[k][r] / ata[r][r];
+
+            for (int c = r; c <= terms; c++)
+                ata[k][c] -= m * ata[r][c];
+        }
+    }
+
+    for (int r = terms - 1; r >= 0; r--)
+    {
+        coef[r] = ata[r][terms];
+
+        for (int c = r + 1; c < terms; c++)
+            coef[r] -= ata[r][c] * coef[c];
+
+        coef[r] /= ata[r][r];
+    }
+
+    for (size_t i = 0; i < n; i++)
+    {
+        double fit = coef[0] +
+            coef[1] * cos(2.0 * M_PI * freq1 * i / rate) + coef[2] * sin(2.0 * M_PI * freq1 * i / rate);
+
+        if (terms == 5)
+            fit += coef[3] * cos(2.0 * M_PI * freq2 * i / rate) + coef[4] * sin(2.0 * M_PI * freq2 * i / rate);
+
+        residual += (x[i] - fit) * (x[i] - fit);
+
+        if (resid)
+            resid[i] = x[i] - fit;
+    }
+
+    *power1 = (coef[1] * coef[1] + coef[2] * coef[2]) / 2.0;
+    *power2 = terms == 5 ? (coef[3] * coef[3] + coef[4] * coef[4]) / 2.0 : 0.0;
+
+    return residual / n;
+}
+
+void goertzel_analyse(const double *x, size_t n, double rate, tone_analysis_t *result)
+{
+    double *w = malloc(n * sizeof(double));
+    double mean = 0.0;
+    double peak1 = 0.0, peak1_power = 0.0;
+    double peak2 = 0.0, peak2_power = 0.0;
+
+    memset(result, 0, sizeof(*result));
+    result->digit = '?';
+
+    if (!w || n < 16)
+    {
+        free(w);
+        return;
+    }
+
+    for (size_t i = 0; i < n; i++)
+        mean += x[i];
+
+    mean /= n;
+
+    // Remove DC and apply a Hann window to keep the two tones from leaking into each other
+    for (size_t i = 0; i < n; i++)
+    {
+        double hann = 0.5 - 0.5 * cos(2.0 * M_PI * i / (n - 1));
+
+        w[i] = (x[i] - mean) * hann;
+    }
+
+    // Coarse scan for the strongest peak, then the strongest one well away from it
+    for (double f = SCAN_LOW_HZ; f <= SCAN_HIGH_HZ; f += SCAN_STEP_HZ)
+    {
+        double p = goertzel_power(w, n, f, rate);
+
+        if (p > peak1_power)
+        {
+            peak1_power = p;
+            peak1 = f;
+        }
+    }
+
+    for (double f = SCAN_LOW_HZ; f <= SCAN_HIGH_HZ; f += SCAN_STEP_HZ)
+    {
+        double p = goertzel_power(w, n, f, rate);
+
+        if (fabs(f - peak1) >= MIN_SEPARATION_HZ && p > peak2_power)
+        {
+            peak2_power = p;
+            peak2 = f;
+        }
+    }
+
+    peak1 = refine_peak(w, n, peak1, rate, &peak1_power);
+    peak2 = refine_peak(w, n, peak2, rate, &peak2_power);
+
+    double p1;
+    double p2;
+    double noise = fit_tones(x, n, rate, peak1, peak2, &p1, &p2, NULL);
+
+    if (10.0 * log10(p1 / p2) > SECOND_TONE_DB)
+    {
+        // Single tone (beeps and tunes)
+        result->freq_high = peak1;
+        noise = fit_tones(x, n, rate, peak1, 0.0, &p1, &p2, NULL);
+        result->snr_db = 10.0 * log10(p1 / noise);
+    }
+    else
+    {
+        double low = peak1 < peak2 ? peak1 : peak2;
+        double high = peak1 < peak2 ? peak2 : peak1;
+        double p_low = peak1 < peak2 ? p1 : p2;
+        double p_high = peak1 < peak2 ? p2 : p1;
+        int row = nearest(_g_low_group, low);
+        int col = nearest(_g_high_group, high);
+
+        result->freq_low = low;
+        result->freq_high = high;
+        result->twist_db = 10.0 * log10(p_high / p_low);
+        result->snr_db = 10.0 * log10((p_low + p_high) / noise);
+
+        if (row >= 0 && col >= 0)
+        {
+            result->digit = _g_keypad[row][col];
+            result->err_low = 100.0 * (low - _g_low_group[row]) / _g_low_group[row];
+            result->err_high = 100.0 * (high - _g_high_group[col]) / _g_high_group[col];
+        }
+    }
+
+    free(w);
+}
+
+// Distortion of a single tone of known frequency: THD from harmonics 2-9
+// (folded back into the band, as a sampled system sees them) and THD+N
+// from everything that is not the fundamental, both in dB
+void goertzel_thd(const double *x, size_t n, double rate, double freq, double *thd_db, double *thdn_db)
+{
+    double fundamental;
+    double unused;
+    double harmonics = 0.0;
+    double residual = fit_tones(x, n, rate, freq, 0.0, &fundamental, &unused, NULL);
+
+    for (int k = 2; k <= 9; k++)
+    {
+        double alias = fmod(k * freq, rate);
+        double power;
+
+        if (alias > rate / 2.0)
+            alias = rate - alias;
+
+        // Skip harmonics that fold onto DC or the fundamental
+        if (alias < MIN_SEPARATION_HZ / 10.0 || fabs(alias - freq) < MIN_SEPARATION_HZ / 10.0)
+            continue;
+
+        fit_tones(x, n, rate, alias, 0.0, &power, &unused, NULL);
+        harmonics += power;
+    }
+
+    *thd_db = 10.0 * log10(harmonics / fundamental);
+    *thdn_db = 10.0 * log10(residual / fundamental);
+}
+
+// Power of the tones at freq1 and freq2 (freq2 = 0 for a single tone)
+// against only the noise below band_hz, in dB: what is left after the
+// telephone band filter. The noise is summed over the DFT bins of what
+// the fit leaves, so no window is needed
+double goertzel_band_snr(const double *x, size_t n, double rate, double freq1, double freq2, double band_hz)
+{
+    double *resid = malloc(n * sizeof(double));
+    double p1;
+    double p2;
+    double noise = 0.0;
+
+    if (!resid)
+        return 0.0;
+
+    fit_tones(x, n, rate, freq1, freq2, &p1, &p2, resid);
+
+    // Bin k of an n point DFT holds 2 |X_k|^2 / n^2 of the mean power
+    for (size_t k = 1; k < n / 2 && k * rate / n <= band_hz; k++)
+        noise += 2.0 * goertzel_power(resid, n, k * rate / n, rate) / n / n;
+
+    free(resid);
+    return 10.0 * log10((p1 + p2) / noise);
+}
+
+static bool block_active(const double *x, size_t n)
+{
+    double mean = 0.0;
+    double var = 0.0;
+
+    for (size_t i = 0; i < n; i++)
+        mean += x[i];
+
+    mean /= n;
+
+    for (size_t i = 0; i < n; i++)
+        var += (x[i] - mean) * (x[i] - mean);
+
+    return var / n >= BLOCK_VARIANCE_MIN;
+}
+
+// Split a recording into tones. Silence is anything that does not move,
+// which covers both the PWM being switched off and the DDS being stopped
+size_t goertzel_segment(const double *x, size_t n, double rate, tone_segment_t *segments, size_t max)
+{
+    size_t count = 0;
+
+    for (size_t block = 0; (block + 1) * BLOCK_SAMPLES <= n && count < max; )
+    {
+        size_t start;
+        size_t end;
+
+        if (!block_active(x + block * BLOCK_SAMPLES, BLOCK_SAMPLES))
+        {
+            block++;
+            continue;
+        }
+
+        start = block;
+
+        while ((block + 1) * BLOCK_SAMPLES <= n && block_active(x + block * BLOCK_SAMPLES, BLOCK_SAMPLES))
+            block++;
+
+        end = block;
+
+        // Drop the first and last blocks, they contain the tone switching on and off
+        if (end - start < 3 || (end - start - 2) * BLOCK_SAMPLES * 1000 / rate < MIN_TONE_MS)
+            continue;
+
+        segments[count].start = (start + 1) * BLOCK_SAMPLES;
+        segments[count].len = (end - start - 2) * BLOCK_SAMPLES;
+        count++;
+    }
+
+    return count;
+}
@@ -0,0 +1,41 @@
+//*****************************************************************************
+// Title        : Goertzel DTMF analysis
+// Author       : agent
+// Created      : 2026-10-16
+//
+// Part of the pulse to tone (DTMF) converter.
+//
+// This code is distributed under the GNU Public License
+// which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+#ifndef __GOERTZEL_H__
+#define __GOERTZEL_H__
+
+#include <stddef.h>
+
+typedef struct
+{
+    char digit;             // '0'-'9', '*', '#', 'A'-'D', or '?' for a non DTMF tone
+    double freq_low;        // Measured frequencies in Hz (freq_low = 0 for single tones)
+    double freq_high;
+    double err_low;         // Deviation from nominal in percent
+    double err_high;
+    double twist_db;        // High group level relative to low group level
+    double snr_db;          // Tone power relative to everything else
+} tone_analysis_t;
+
+typedef struct
+{
+    size_t start;           // First sample of the tone
+    size_t len;             // Number of samples
+} tone_segment_t;
+
+double goertzel_power(const double *x, size_t n, double freq, double rate);
+void goertzel_analyse(const double *x, size_t n, double rate, tone_analysis_t *result);
+double goertzel_band_snr(const double *x, size_t n, double rate, double freq1, double freq2, double band_hz);
+void goertzel_thd(const double *x, size_t n, double rate, double freq, double *thd_db, double *thdn_db);
+size_t goertzel_segment(const double *x, size_t n, double rate, tone_segment_t *segments, size_t max);
+
+#endif /* __GOERTZEL_H__ */
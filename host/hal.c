@@ -0,0 +1,92 @@
+//*****************************************************************************
+// Title        : Host model of the ATtiny85 peripherals
+// Author       : agent
+// Created      : 2026-10-16
+//
+// Part of the pulse to tone (DTMF) converter.
+//
+// This code is distributed under the GNU Public License
+// which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+// Host implementation of the few ATtiny85 peripherals the tone generator
+// uses. Registers are plain variables; Timer0 is modelled a PWM period at
+// a time (timer0.c), which is all the DDS needs.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+
+#include "hal.h"
+
+volatile uint8_t TIMSK;
+volatile uint8_t TCCR0A;
+volatile uint8_t TCCR0B;
+volatile uint8_t TCNT0;
+volatile uint8_t OCR0A;
+volatile uint8_t OCR0B;
+volatile uint8_t DDRB;
+volatile uint8_t PORTB;
+volatile uint8_t PINB;
+volatile uint8_t GIMSK;
+volatile uint8_t TCCR1;
+volatile uint8_t OCR1A;
+volatile uint8_t OCR1C;
+volatile uint8_t PRR;
+volatile uint8_t MCUSR;                     // watchdog, set up by timer.c but not modelled
+volatile uint8_t WDTCR;
+
+uint8_t host_sleep_mode;
+
+static hal_sample_sink_t _g_sink;
+static void *_g_sink_ctx;
+static uint32_t _g_samples;
+
+void hal_set_sample_sink(hal_sample_sink_t sink, void *ctx)
+{
+    _g_sink = sink;
+    _g_sink_ctx = ctx;
+}
+
+uint32_t hal_sample_count(void)
+{
+    return _g_samples;
+}
+
+void host_wdt_reset(void)
+{
+}
+
+// Busy waits take no time here either
+void host_delay_loop(uint16_t count)
+{
+    (void)count;
+}
+
+// Sleeping is one PWM period, which is how often the Timer0 overflow
+// wakes the CPU while a tone plays. While silent that is more often than
+// the real part, which the firmware takes as a wake up for nothing
+void host_sleep(void)
+{
+    uint8_t sample;
+
+    host_timer0_tick();
+
+    // OC0A is only connected to the pin in non-inverting mode, !OC1A
+    // (DTMF_PLL_PWM) with COM1A = 01, otherwise the port drives it.
+    // Either way this is the duty cycle over the sample period
+    if (TCCR0A & _BV(COM0A1))
+        sample = OCR0A;
+    else if ((TCCR1 & (_BV(COM1A1) | _BV(COM1A0))) == _BV(COM1A0))
+        sample = ~OCR1A;
+    else
+        sample = (PORTB & _BV(PB0)) ? 0xFF : 0x00;
+
+    _g_samples++;
+
+    if (_g_sink)
+        _g_sink(sample, _g_sink_ctx);
+}
@@ -0,0 +1,29 @@
+//*****************************************************************************
+// Title        : Host model of the ATtiny85 peripherals
+// Author       : agent
+// Created      : 2026-10-16
+//
+// Part of the pulse to tone (DTMF) converter.
+//
+// This code is distributed under the GNU Public License
+// which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+#ifndef __HAL_H__
+#define __HAL_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Called with the PWM duty cycle (0-255) seen on OC0A for every
+// Timer0 overflow, i.e. at F_CPU / 256 samples per second
+typedef void (*hal_sample_sink_t)(uint8_t sample, void *ctx);
+
+void hal_set_sample_sink(hal_sample_sink_t sink, void *ctx);
+uint32_t hal_sample_count(void);
+bool host_timer0_tick(void);
+uint32_t host_timer0_wake(void);
+void host_timer0_skip(uint32_t periods);
+
+#endif /* __HAL_H__ */
@@ -0,0 +1,192 @@
+//*****************************************************************************
+// Title        : Dial state machine checker
+// Author       : agent
+// Created      : 2026-10-16
+//
+// Part of the pulse to tone (DTMF) converter.
+//
+// This code is distributed under the GNU Public License
+// which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+// Checks the dial state machine table in ../menu.c by trying every
+// sequence of events (digits 0-9, holding the dial, waking at rest) up to
+// a given length from STATE_DIAL.
+//
+//   menucheck [-d depth] [-v]
+//
+// Fails if an entry is out of range, a state can't be reached, or a
+// reachable state has no way back to STATE_DIAL within depth events
+// without the EV_IDLE time out. -v prints the shortest way into every
+// state and every entry never used.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "../menu.h"
+
+#define DEFAULT_DEPTH           6
+#define MAX_DEPTH               12
+
+static const char *_g_state_names[STATE_COUNT] =
+{
+    "DIAL", "SPECIAL_L1", "SPECIAL_L2", "PROGRAM_SD", "TIMING_SLOT", "TIMING_PROFILE", "REDIAL_HISTORY"
+};
+
+static int _g_shortest[STATE_COUNT];
+static uint8_t _g_shortest_path[STATE_COUNT][MAX_DEPTH];
+static bool _g_used[STATE_COUNT][EV_COUNT];
+static unsigned long _g_sequences;
+
+static const char *event_name(uint8_t event)
+{
+    static const char *digits[] = { "0", "1", "2", "3", "4", "5", "6", "7", "8", "9" };
+
+    if (event == EV_HOLD)
+        return "hold";
+
+    if (event == EV_IDLE)
+        return "idle";
+
+    return digits[event];
+}
+
+// Every sequence from state, recording how each state was first reached
+static void enumerate(uint8_t state, uint8_t *path, int depth, int max_depth)
+{
+    if (depth < _g_shortest[state])
+    {
+        _g_shortest[state] = depth;
+
+        for (int i = 0; i < depth; i++)
+            _g_shortest_path[state][i] = path[i];
+    }
+
+    if (depth == max_depth)
+    {
+        _g_sequences++;
+        return;
+    }
+
+    for (uint8_t event = 0; event < EV_COUNT; event++)
+    {
+        _g_used[state][event] = true;
+        path[depth] = event;
+        enumerate(MENU_NEXT(menu_lookup(state, event)), path, depth + 1, max_depth);
+    }
+}
+
+// Can the user get back to STATE_DIAL by dialing, without waiting?
+static bool returns(uint8_t state, int depth)
+{
+    if (state == STATE_DIAL)
+        return true;
+
+    if (!depth)
+        return false;
+
+    for (uint8_t event = 0; event < EV_COUNT; event++)
+    {
+        if (event != EV_IDLE && returns(MENU_NEXT(menu_lookup(state, event)), depth - 1))
+            return true;
+    }
+
+    return false;
+}
+
+int main(int argc, char **argv)
+{
+    int depth = DEFAULT_DEPTH;
+    bool verbose = false;
+    uint8_t path[MAX_DEPTH];
+    int errors = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "d:v")) != -1)
+    {
+        switch (opt)
+        {
+            case 'd':
+                depth = atoi(optarg);
+                break;
+            case 'v':
+                verbose = true;
+                break;
+            default:
+                fprintf(stderr, "Usage: menucheck [-d depth] [-v]\n");
+                return 2;
+        }
+    }
+
+    if (depth < 1 || depth > MAX_DEPTH)
+    {
+        fprintf(stderr, "Depth must be 1 to %d\n", MAX_DEPTH);
+        return 2;
+    }
+
+    for (uint8_t state = 0; state < STATE_COUNT; state++)
+    {
+        _g_shortest[state] = depth + 1;
+
+        for (uint8_t event = 0; event < EV_COUNT; event++)
+        {
+            uint8_t entry = menu_lookup(state, event);
+
+            if (MENU_ACTION(entry) >= A_COUNT || MENU_NEXT(entry) >= STATE_COUNT)
+            {
+                printf("%s on %s: action %d, next state %d out of range\n",
+                    _g_state_names[state], event_name(event), MENU_ACTION(entry), MENU_NEXT(entry));
+                return 1;
+            }
+        }
+    }
+
+    enumerate(STATE_DIAL, path, 0, depth);
+
+    for (uint8_t state = 0; state < STATE_COUNT; state++)
+    {
+        if (_g_shortest[state] > depth)
+        {
+            printf("%s: unreachable\n", _g_state_names[state]);
+            errors++;
+            continue;
+        }
+
+        if (!returns(state, depth))
+        {
+            printf("%s: stuck, no way back to DIAL in %d events\n", _g_state_names[state], depth);
+            errors++;
+        }
+
+        if (verbose)
+        {
+            printf("%-16s", _g_state_names[state]);
+
+            for (int i = 0; i < _g_shortest[state]; i++)
+                printf(" %s", event_name(_g_shortest_path[state][i]));
+
+            printf("\n");
+        }
+    }
+
+    if (verbose)
+    {
+        for (uint8_t state = 0; state < STATE_COUNT; state++)
+        {
+            for (uint8_t event = 0; event < EV_COUNT; event++)
+            {
+                if (_g_shortest[state] <= depth && !_g_used[state][event])
+                    printf("%s on %s: never used within %d events\n", _g_state_names[state], event_name(event), depth);
+            }
+        }
+    }
+
+    printf("%d states, %d events, %lu sequences of %d events, %d problems\n",
+        STATE_COUNT, EV_COUNT, _g_sequences, depth, errors);
+
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,223 @@
+//*****************************************************************************
+// Title        : Pulse contact trace replay
+// Author       : agent
+// Created      : 2026-10-16
+//
+// Part of the pulse to tone (DTMF) converter.
+//
+// This code is distributed under the GNU Public License
+// which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+// Replays recorded pulse contact traces through the firmware's pulse
+// capture (../pulse.c), with Timer0 and INT0 driven by the host HAL the
+// way the firmware would see them, and checks every digit decodes.
+//
+//   pulsetool [-v] file.trace ...
+//
+// A trace is a list of lines, times in ms from the start of the file:
+//
+//   off <ms>                   dial leaves the rest position
+//   <ms> <0|1>                 pulse contact goes to make (0) or break (1)
+//   rest <ms> <pulses>         dial back at rest, expected pulse count,
+//                              -1 if edges are lost and the digit is void
+//
+// Anything after a # is a comment. Each file starts on a wrap of the
+// silent Timer0 count (every 65.536 ms at 4MHz). Exits non zero if any
+// digit decodes wrong. -v prints every digit rather than just the totals:
+// raw edges, the dial rate and break ratio measured and how long after
+// returning to rest the digit was complete (the firmware used to wait a
+// fixed 128 ms).
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+
+#include "../dds.h"
+#include "../dtmf.h"
+#include "../pulse.h"
+#include "../timer.h"
+#include "hal.h"
+
+#define TICK_MS             (256 * 1000.0 / F_CPU)
+
+static bool _g_verbose;
+static double _g_settle_total;
+static double _g_settle_max;
+
+// Let Timer0 run up to the given time, the main loop polling after every
+// overflow like start_sleep() does
+static void run_until(double ms)
+{
+    while (hal_sample_count() * TICK_MS < ms)
+    {
+        host_sleep();
+
+        if (pulse_active())
+            pulse_poll();
+    }
+}
+
+static void set_pulse_pin(bool level)
+{
+    if (level == !!bit_is_set(PINB, PIN_PULSE))
+        return;
+
+    if (level)
+        PINB |= _BV(PIN_PULSE);
+    else
+        PINB &= ~_BV(PIN_PULSE);
+
+    // Both edges interrupt
+    INT0_vect();
+}
+
+// Returns the number of digits decoded wrong, or -1 if the file is unusable
+static int replay(const char *path, int *digits)
+{
+    char line[128];
+    int lineno = 0;
+    int errors = 0;
+    int edges = 0;
+    double base;
+    FILE *f;
+
+    // Start on a wrap of the silent Timer0 count, so a trace can put
+    // edges next to one
+    run_until(((hal_sample_count() + TIMER_SLOW_WRAP - 1) / TIMER_SLOW_WRAP) * TIMER_SLOW_WRAP * TICK_MS);
+    base = hal_sample_count() * TICK_MS;
+    f = fopen(path, "r");
+
+    if (!f)
+    {
+        perror(path);
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), f))
+    {
+        char *hash = strchr(line, '#');
+        double ms;
+        int value;
+
+        lineno++;
+
+        if (hash)
+            *hash = '\0';
+
+        if (sscanf(line, " off %lf", &ms) == 1)
+        {
+            run_until(base + ms);
+            pulse_start();
+            edges = 0;
+        }
+        else if (sscanf(line, " rest %lf %d", &ms, &value) == 2)
+        {
+            int count;
+            double settle;
+            uint16_t period;
+
+            run_until(base + ms);
+            pulse_rest();
+
+            // Like main(), until the digit is complete
+            while (pulse_count() && !pulse_ready())
+                run_until(hal_sample_count() * TICK_MS + TICK_MS / 2);
+
+            settle = hal_sample_count() * TICK_MS - (base + ms);
+            period = pulse_period();
+            count = pulse_lost() ? -1 : pulse_count();
+            (*digits)++;
+
+            _g_settle_total += settle;
+
+            if (settle > _g_settle_max)
+                _g_settle_max = settle;
+
+            if (count != value)
+                errors++;
+
+            if (_g_verbose || count != value)
+            {
+                printf("%s:%d: %d edges, %d pulses, expected %d", path, lineno, edges, count, value);
+
+                if (period)
+                    printf(", %.1f pps %d%% break", 1000.0 / (period * TICK_MS), pulse_break() * 100 / period);
+
+                printf(", complete after %.1f ms%s\n", settle, count != value ? " FAIL" : "");
+            }
+
+            pulse_stop();
+        }
+        else if (sscanf(line, " %lf %d", &ms, &value) == 2)
+        {
+            run_until(base + ms);
+            set_pulse_pin(value);
+            edges++;
+        }
+        else if (strspn(line, " \t\r\n") != strlen(line))
+        {
+            fprintf(stderr, "%s:%d: can't parse\n", path, lineno);
+            fclose(f);
+            return -1;
+        }
+    }
+
+    fclose(f);
+
+    return errors;
+}
+
+int main(int argc, char **argv)
+{
+    int digits = 0;
+    int errors = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "v")) != -1)
+    {
+        switch (opt)
+        {
+            case 'v':
+                _g_verbose = true;
+                break;
+            default:
+                fprintf(stderr, "Usage: pulsetool [-v] file.trace ...\n");
+                return 2;
+        }
+    }
+
+    if (optind == argc)
+    {
+        fprintf(stderr, "Usage: pulsetool [-v] file.trace ...\n");
+        return 2;
+    }
+
+    dtmf_init();
+
+    for (int i = optind; i < argc; i++)
+    {
+        int result = replay(argv[i], &digits);
+
+        if (result < 0)
+            return 2;
+
+        errors += result;
+    }
+
+    printf("%d digits, %d decoded wrong (min break %d ms, min make %d ms)\n",
+        digits, errors, PULSE_MIN_BREAK_MS, PULSE_MIN_MAKE_MS);
+
+    if (digits)
+        printf("Digit complete after returning to rest: %.1f ms average, %.1f ms worst\n",
+            _g_settle_total / digits, _g_settle_max);
+
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,629 @@
+//*****************************************************************************
+// Title        : Firmware simulation under simavr
+// Author       : agent
+// Created      : 2026-10-16
+//
+// Part of the pulse to tone (DTMF) converter.
+//
+// This code is distributed under the GNU Public License
+// which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+// Runs the real firmware (rotarydial.elf) under simavr, drives the dial
+// contacts from a script and decodes what comes out of OC0A.
+//
+//   simdial [-e] [-t tail_ms] [-w out.wav] rotarydial.elf script.dial
+//
+// Script lines (times in ms, '#' starts a comment):
+//   wait <ms>                                 dial at rest for a while
+//   dial <digit> [hold <ms>] [pps <n>] [break <percent>]
+//                                             wind the dial, optionally hold it
+//                                             at the finger stop, then release
+//
+// For every dial line the tool reports the latency from the dial returning
+// to rest to the first tone sample, what was decoded and when the last tone
+// of the burst ended, which for a speed dial is the whole playback time.
+// It also times every TIMER0_OVF_vect invocation (vector to reti) and the
+// INT0 latency: cycles from each break (pulse contact opening) to INT0_vect.
+//
+// -e adds where the time went: every cycle is counted as active, idle
+// (SLEEP_MODE_IDLE, i.e. inside sleep_ms() or waiting on Timer0) or power
+// down with and without the watchdog running, per dial line (from that dial
+// reaching rest to the next one) and for the whole script including the
+// tail. Each is then charged at the typical supply current from the ATtiny85
+// datasheet to give the charge drawn in uA*s, which is what the line has to
+// supply per call.
+//
+// Only Timer0 output (OCR0A) is captured and only the core's currents are
+// charged, so -DDTMF_PLL_PWM builds (tone on Timer1 from the PLL) are not
+// covered: no tones decode and the PLL's current is missing.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <simavr/sim_avr.h>
+#include <simavr/sim_elf.h>
+#include <simavr/avr_ioport.h>
+#include <simavr/avr_timer.h>
+
+#include "goertzel.h"
+
+#define PIN_DIAL            1       // PB1, high at rest
+#define PIN_PULSE           2       // PB2 (INT0), high while the pulse contact is open
+
+#define DEFAULT_TAIL_MS     8000
+#define DEFAULT_PPS         10
+#define DEFAULT_BREAK       60      // Break/make ratio 60/40 (percent break)
+#define DIAL_LEAD_MS        50      // Off-normal to first break once released
+#define DIAL_TRAIL_MS       30      // Last make to off-normal contact opening
+#define MAX_EVENTS          4096
+#define MAX_DIALS           256
+#define MAX_TONES           256
+#define PWM_PERIOD          256
+#define INT0_VECTOR         1
+#define TIMER0_OVF_VECTOR   5
+#define MCUCR_ADDR          0x55    // data space address (I/O 0x35)
+#define WDTCR_ADDR          0x41    // data space address (I/O 0x21)
+#define MCUCR_SM_MASK       0x18    // SM1:0
+#define MCUCR_SM_PWR_DOWN   0x10
+#define WDTCR_WDIE          0x40
+#define WDTCR_WDE           0x08
+
+// Typical supply current at VCC = 3V (ATtiny25/45/85 datasheet, DC
+// characteristics). Active and idle are given at 4MHz and scale about
+// linearly with the clock
+#define CURRENT_ACTIVE_UA   (1500.0 * F_CPU / 4000000)
+#define CURRENT_IDLE_UA     (350.0 * F_CPU / 4000000)
+#define CURRENT_PD_WDT_UA   4.0
+#define CURRENT_PD_UA       0.15
+
+typedef enum
+{
+    E_ACTIVE,
+    E_IDLE,
+    E_PWR_DOWN_WDT,
+    E_PWR_DOWN,
+    E_COUNT
+} energy_mode_t;
+
+static const double _g_mode_current[E_COUNT] = { CURRENT_ACTIVE_UA, CURRENT_IDLE_UA, CURRENT_PD_WDT_UA, CURRENT_PD_UA };
+
+typedef struct
+{
+    avr_cycle_count_t when;
+    uint8_t pin;
+    uint8_t value;
+} pin_event_t;
+
+typedef struct
+{
+    char text[64];
+    avr_cycle_count_t rest;
+} dial_action_t;
+
+typedef struct
+{
+    avr_cycle_count_t when;
+    uint8_t value;
+} ocr_change_t;
+
+static avr_t *_g_avr;
+static avr_irq_t *_g_pins[8];
+static pin_event_t _g_events[MAX_EVENTS];
+static int _g_num_events;
+static int _g_next_event;
+static dial_action_t _g_dials[MAX_DIALS];
+static int _g_num_dials;
+static ocr_change_t *_g_ocr;
+static size_t _g_num_ocr;
+static size_t _g_ocr_size;
+static bool _g_done;
+
+typedef struct
+{
+    uint32_t calls;
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+} cycle_stats_t;
+
+static cycle_stats_t _g_isr = { .min = UINT32_MAX };
+static cycle_stats_t _g_int0 = { .min = UINT32_MAX };
+static avr_cycle_count_t _g_break_edge;
+static bool _g_break_pending;
+static uint32_t _g_breaks_missed;
+
+// Cycles per mode before the first dial reaches rest (row 0), then from
+// each dial reaching rest to the next
+static avr_cycle_count_t _g_energy[MAX_DIALS + 1][E_COUNT];
+static int _g_energy_row;
+
+static avr_cycle_count_t ms_to_cycles(double ms)
+{
+    return (avr_cycle_count_t)(ms * (_g_avr->frequency / 1000.0));
+}
+
+static double cycles_to_ms(avr_cycle_count_t cycles)
+{
+    return cycles * 1000.0 / _g_avr->frequency;
+}
+
+static void stats_add(cycle_stats_t *stats, uint32_t cycles)
+{
+    stats->calls++;
+    stats->total += cycles;
+
+    if (cycles < stats->min)
+        stats->min = cycles;
+    if (cycles > stats->max)
+        stats->max = cycles;
+}
+
+static void stats_print(const char *name, const char *what, const cycle_stats_t *stats)
+{
+    printf("%s: %u %s, cycles min/avg/max %u/%.1f/%u", name, stats->calls, what,
+        stats->min, (double)stats->total / stats->calls, stats->max);
+}
+
+// What the CPU is doing right now, as far as current goes
+static energy_mode_t energy_mode(void)
+{
+    uint8_t wdtcr = _g_avr->data[WDTCR_ADDR];
+
+    if (_g_avr->state != cpu_Sleeping)
+        return E_ACTIVE;
+
+    if ((_g_avr->data[MCUCR_ADDR] & MCUCR_SM_MASK) != MCUCR_SM_PWR_DOWN)
+        return E_IDLE;
+
+    return (wdtcr & (WDTCR_WDIE | WDTCR_WDE)) ? E_PWR_DOWN_WDT : E_PWR_DOWN;
+}
+
+static void energy_add(energy_mode_t mode, avr_cycle_count_t from, avr_cycle_count_t cycles)
+{
+    while (_g_energy_row < _g_num_dials && _g_dials[_g_energy_row].rest <= from)
+        _g_energy_row++;
+
+    _g_energy[_g_energy_row][mode] += cycles;
+}
+
+// Charge drawn over one row, in uA*s
+static double energy_charge(const avr_cycle_count_t *cycles)
+{
+    double charge = 0;
+
+    for (int m = 0; m < E_COUNT; m++)
+        charge += _g_mode_current[m] * cycles_to_ms(cycles[m]) / 1000.0;
+
+    return charge;
+}
+
+static void energy_print_row(const char *name, const avr_cycle_count_t *cycles)
+{
+    printf("%-32s %10.1f %10.1f %10.1f %10.1f %10.1f\n", name, cycles_to_ms(cycles[E_ACTIVE]),
+        cycles_to_ms(cycles[E_IDLE]), cycles_to_ms(cycles[E_PWR_DOWN_WDT]), cycles_to_ms(cycles[E_PWR_DOWN]),
+        energy_charge(cycles));
+}
+
+static void energy_report(void)
+{
+    avr_cycle_count_t total[E_COUNT] = { 0 };
+    avr_cycle_count_t all = 0;
+    double charge;
+
+    printf("\n%-32s %10s %10s %10s %10s %10s\n", "action", "active_ms", "idle_ms", "pd_wdt_ms", "pd_ms", "uA*s");
+    energy_print_row("power up", _g_energy[0]);
+
+    for (int d = 0; d < _g_num_dials; d++)
+        energy_print_row(_g_dials[d].text, _g_energy[d + 1]);
+
+    for (int d = 0; d <= _g_num_dials; d++)
+    {
+        for (int m = 0; m < E_COUNT; m++)
+            total[m] += _g_energy[d][m];
+    }
+
+    for (int m = 0; m < E_COUNT; m++)
+        all += total[m];
+
+    energy_print_row("total", total);
+    charge = energy_charge(total);
+    printf("Energy: %.1f uA*s over %.1f s, %.1f uA average, %.1f%% of the time awake\n", charge,
+        cycles_to_ms(all) / 1000.0, charge * 1000.0 / cycles_to_ms(all),
+        100.0 * (total[E_ACTIVE] + total[E_IDLE]) / all);
+}
+
+static void add_event(avr_cycle_count_t when, uint8_t pin, uint8_t value)
+{
+    if (_g_num_events == MAX_EVENTS)
+    {
+        fprintf(stderr, "Script too long\n");
+        exit(1);
+    }
+
+    _g_events[_g_num_events].when = when;
+    _g_events[_g_num_events].pin = pin;
+    _g_events[_g_num_events].value = value;
+    _g_num_events++;
+}
+
+// Turns the script into a list of pin changes, returns the time it ends
+static avr_cycle_count_t load_script(const char *path)
+{
+    FILE *fp = fopen(path, "r");
+    avr_cycle_count_t t = 0;
+    char line[256];
+    int lineno = 0;
+
+    if (!fp)
+    {
+        perror(path);
+        exit(1);
+    }
+
+    // Both contacts idle: dial at rest, pulse contact closed
+    add_event(0, PIN_DIAL, 1);
+    add_event(0, PIN_PULSE, 0);
+
+    while (fgets(line, sizeof(line), fp))
+    {
+        char *cmd;
+        char *comment = strchr(line, '#');
+
+        lineno++;
+
+        if (comment)
+            *comment = '\0';
+
+        if (!(cmd = strtok(line, " \t\r\n")))
+            continue;
+
+        if (!strcmp(cmd, "wait"))
+        {
+            char *arg = strtok(NULL, " \t\r\n");
+
+            t += ms_to_cycles(arg ? atof(arg) : 0);
+        }
+        else if (!strcmp(cmd, "dial"))
+        {
+            char *arg = strtok(NULL, " \t\r\n");
+            double hold = 0;
+            double pps = DEFAULT_PPS;
+            double brk = DEFAULT_BREAK;
+            int pulses;
+
+            if (!arg || arg[0] < '0' || arg[0] > '9' || _g_num_dials == MAX_DIALS)
+            {
+                fprintf(stderr, "%s:%d: bad dial command\n", path, lineno);
+                exit(1);
+            }
+
+            pulses = arg[0] == '0' ? 10 : arg[0] - '0';
+            snprintf(_g_dials[_g_num_dials].text, sizeof(_g_dials[0].text), "dial %c", arg[0]);
+
+            while ((arg = strtok(NULL, " \t\r\n")))
+            {
+                char *value = strtok(NULL, " \t\r\n");
+                size_t len = strlen(_g_dials[_g_num_dials].text);
+
+                if (!value)
+                    break;
+
+                snprintf(_g_dials[_g_num_dials].text + len, sizeof(_g_dials[0].text) - len, " %s %s", arg, value);
+
+                if (!strcmp(arg, "hold"))
+                    hold = atof(value);
+                else if (!strcmp(arg, "pps"))
+                    pps = atof(value);
+                else if (!strcmp(arg, "break"))
+                    brk = atof(value);
+            }
+
+            double period = 1000.0 / pps;
+
+            add_event(t, PIN_DIAL, 0);
+            t += ms_to_cycles(hold + DIAL_LEAD_MS);
+
+            for (int i = 0; i < pulses; i++)
+            {
+                add_event(t, PIN_PULSE, 1);
+                add_event(t + ms_to_cycles(period * brk / 100.0), PIN_PULSE, 0);
+                t += ms_to_cycles(period);
+            }
+
+            t += ms_to_cycles(DIAL_TRAIL_MS);
+            add_event(t, PIN_DIAL, 1);
+            _g_dials[_g_num_dials++].rest = t;
+        }
+        else
+        {
+            fprintf(stderr, "%s:%d: unknown command '%s'\n", path, lineno, cmd);
+            exit(1);
+        }
+    }
+
+    fclose(fp);
+    return t;
+}
+
+static avr_cycle_count_t script_timer(avr_t *avr, avr_cycle_count_t when, void *param)
+{
+    while (_g_next_event < _g_num_events && _g_events[_g_next_event].when <= when)
+    {
+        pin_event_t *e = &_g_events[_g_next_event++];
+
+        avr_raise_irq(_g_pins[e->pin], e->value);
+
+        // A break not serviced before the following make never will be
+        if (e->pin == PIN_PULSE)
+        {
+            if (_g_break_pending)
+                _g_breaks_missed++;
+
+            _g_break_pending = e->value;
+            _g_break_edge = avr->cycle;
+        }
+    }
+
+    return _g_next_event < _g_num_events ? _g_events[_g_next_event].when : 0;
+}
+
+static avr_cycle_count_t end_timer(avr_t *avr, avr_cycle_count_t when, void *param)
+{
+    _g_done = true;
+    return 0;
+}
+
+static void ocr_hook(struct avr_irq_t *irq, uint32_t value, void *param)
+{
+    if (_g_num_ocr && _g_ocr[_g_num_ocr - 1].value == value)
+        return;
+
+    if (_g_num_ocr == _g_ocr_size)
+    {
+        _g_ocr_size = _g_ocr_size ? _g_ocr_size * 2 : 65536;
+        _g_ocr = realloc(_g_ocr, _g_ocr_size * sizeof(ocr_change_t));
+
+        if (!_g_ocr)
+        {
+            fprintf(stderr, "Out of memory\n");
+            exit(1);
+        }
+    }
+
+    _g_ocr[_g_num_ocr].when = _g_avr->cycle;
+    _g_ocr[_g_num_ocr].value = value;
+    _g_num_ocr++;
+}
+
+// Rebuilds the PWM duty cycle stream at one sample per PWM period
+static double *ocr_to_samples(avr_cycle_count_t end, size_t *count)
+{
+    size_t n = end / PWM_PERIOD;
+    double *x = malloc(n * sizeof(double));
+    size_t next = 0;
+    double value = 0;
+
+    for (size_t i = 0; x && i < n; i++)
+    {
+        while (next < _g_num_ocr && _g_ocr[next].when <= (avr_cycle_count_t)i * PWM_PERIOD)
+            value = _g_ocr[next++].value;
+
+        x[i] = value;
+    }
+
+    *count = n;
+    return x;
+}
+
+static void write_wav(const char *path, const double *x, size_t n, uint32_t rate)
+{
+    FILE *fp = fopen(path, "wb");
+    uint32_t header[] = { 36 + n, 16, 0x00010001, rate, rate, 0x00080001, n };
+
+    if (!fp)
+    {
+        perror(path);
+        return;
+    }
+
+    // Little endian host assumed
+    fwrite("RIFF", 1, 4, fp);
+    fwrite(&header[0], 4, 1, fp);
+    fwrite("WAVEfmt ", 1, 8, fp);
+    fwrite(&header[1], 4, 5, fp);
+    fwrite("data", 1, 4, fp);
+    fwrite(&header[6], 4, 1, fp);
+
+    for (size_t i = 0; i < n; i++)
+        fputc((uint8_t)x[i], fp);
+
+    fclose(fp);
+}
+
+static void report(avr_cycle_count_t end)
+{
+    double rate = _g_avr->frequency / (double)PWM_PERIOD;
+    size_t count;
+    double *x = ocr_to_samples(end, &count);
+    tone_segment_t *segments = malloc(MAX_TONES * sizeof(tone_segment_t));
+    size_t found = goertzel_segment(x, count, rate, segments, MAX_TONES);
+    size_t seg = 0;
+
+    printf("%-32s %10s %10s %10s  %s\n", "action", "rest_ms", "first_ms", "last_ms", "decoded");
+
+    for (int d = 0; d < _g_num_dials; d++)
+    {
+        avr_cycle_count_t from = _g_dials[d].rest;
+        avr_cycle_count_t to = d + 1 < _g_num_dials ? _g_dials[d + 1].rest : end;
+        double first = -1;
+        double last = -1;
+        char decoded[MAX_TONES + 1];
+        int digits = 0;
+
+        // Latency is taken from the raw OCR0A writes, not the (block aligned) segments
+        for (size_t i = 0; i < _g_num_ocr; i++)
+        {
+            if (_g_ocr[i].when > from && _g_ocr[i].when < to)
+            {
+                first = cycles_to_ms(_g_ocr[i].when - from);
+                break;
+            }
+        }
+
+        for (; seg < found && (avr_cycle_count_t)segments[seg].start * PWM_PERIOD < from; seg++)
+            ;
+
+        for (; seg < found && (avr_cycle_count_t)segments[seg].start * PWM_PERIOD < to; seg++)
+        {
+            tone_analysis_t a;
+
+            goertzel_analyse(x + segments[seg].start, segments[seg].len, rate, &a);
+            decoded[digits++] = a.digit;
+            last = cycles_to_ms((avr_cycle_count_t)(segments[seg].start + segments[seg].len) * PWM_PERIOD - from);
+        }
+
+        decoded[digits] = '\0';
+
+        printf("%-32s %10.1f %10.1f %10.1f  %s\n", _g_dials[d].text, cycles_to_ms(from), first, last, decoded);
+    }
+
+    free(segments);
+    free(x);
+}
+
+int main(int argc, char **argv)
+{
+    elf_firmware_t fw;
+    double tail_ms = DEFAULT_TAIL_MS;
+    const char *wav_path = NULL;
+    bool energy = false;
+    avr_cycle_count_t end;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "et:w:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'e':
+                energy = true;
+                break;
+            case 't':
+                tail_ms = atof(optarg);
+                break;
+            case 'w':
+                wav_path = optarg;
+                break;
+            default:
+                return 2;
+        }
+    }
+
+    if (argc - optind != 2)
+    {
+        fprintf(stderr, "Usage: simdial [-e] [-t tail_ms] [-w out.wav] rotarydial.elf script.dial\n");
+        return 2;
+    }
+
+    memset(&fw, 0, sizeof(fw));
+
+    if (elf_read_firmware(argv[optind], &fw))
+    {
+        fprintf(stderr, "%s: unable to load firmware\n", argv[optind]);
+        return 1;
+    }
+
+    if (!(_g_avr = avr_make_mcu_by_name("attiny85")))
+    {
+        fprintf(stderr, "simavr has no attiny85 support\n");
+        return 1;
+    }
+
+    avr_init(_g_avr);
+    avr_load_firmware(_g_avr, &fw);
+    _g_avr->frequency = F_CPU;
+    _g_avr->log = LOG_ERROR;
+
+    for (int i = 0; i < 8; i++)
+        _g_pins[i] = avr_io_getirq(_g_avr, AVR_IOCTL_IOPORT_GETIRQ('B'), i);
+
+    avr_irq_register_notify(avr_io_getirq(_g_avr, AVR_IOCTL_TIMER_GETIRQ('0'), TIMER_IRQ_OUT_PWM0),
+        ocr_hook, NULL);
+
+    end = load_script(argv[optind + 1]) + ms_to_cycles(tail_ms);
+
+    avr_cycle_timer_register(_g_avr, 1, script_timer, NULL);
+    avr_cycle_timer_register(_g_avr, end, end_timer, NULL);
+
+    avr_flashaddr_t isr_vector = TIMER0_OVF_VECTOR * _g_avr->vector_size;
+    avr_flashaddr_t int0_vector = INT0_VECTOR * _g_avr->vector_size;
+    avr_cycle_count_t isr_start = 0;
+    bool in_isr = false;
+
+    while (!_g_done)
+    {
+        avr_cycle_count_t before = _g_avr->cycle;
+        energy_mode_t mode = energy_mode();
+        int state = avr_run(_g_avr);
+
+        // A sleeping step jumps straight to the next timer or interrupt
+        energy_add(mode, before, _g_avr->cycle - before);
+
+        if (state == cpu_Done || state == cpu_Crashed)
+        {
+            fprintf(stderr, "Firmware stopped (state %d) at %.1f ms\n", state, cycles_to_ms(_g_avr->cycle));
+            return 1;
+        }
+
+        if (_g_break_pending && _g_avr->pc == int0_vector)
+        {
+            _g_break_pending = false;
+            stats_add(&_g_int0, _g_avr->cycle - _g_break_edge);
+        }
+
+        // Interrupts don't nest, so the ISR ends when reti sets I again
+        if (!in_isr && _g_avr->pc == isr_vector)
+        {
+            in_isr = true;
+            isr_start = _g_avr->cycle;
+        }
+        else if (in_isr && _g_avr->sreg[S_I])
+        {
+            in_isr = false;
+            stats_add(&_g_isr, _g_avr->cycle - isr_start);
+        }
+    }
+
+    report(end);
+
+    if (_g_isr.calls)
+    {
+        stats_print("TIMER0_OVF_vect", "calls", &_g_isr);
+        printf(", %.1f%% of each PWM period\n", 100.0 * _g_isr.total / _g_isr.calls / PWM_PERIOD);
+    }
+
+    if (_g_int0.calls)
+    {
+        stats_print("INT0_vect latency", "breaks", &_g_int0);
+        printf(", %u breaks missed\n", _g_breaks_missed);
+    }
+
+    if (energy)
+        energy_report();
+
+    if (wav_path)
+    {
+        size_t count;
+        double *x = ocr_to_samples(end, &count);
+
+        write_wav(wav_path, x, count, _g_avr->frequency / PWM_PERIOD);
+        free(x);
+    }
+
+    return 0;
+}
@@ -0,0 +1,212 @@
+//*****************************************************************************
+// Title        : Host model of Timer0
+// Author       : agent
+// Created      : 2026-10-16
+//
+// Part of the pulse to tone (DTMF) converter.
+//
+// This code is distributed under the GNU Public License
+// which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+// Host model of Timer0, shared by hal.c and dialfuzz.c: advanced one PWM
+// period (256 CPU cycles) at a time, or while idle straight to the next
+// period that runs an interrupt. Only the two clocks the firmware uses
+// (F_CPU and F_CPU/1024, see timer.c) are modelled. Like the part, a
+// compare match sets its flag in TIFR the timer clock after the match and
+// an overflow as the count goes to 0, and an interrupt runs from its flag
+// once enabled, clearing it. Also the PLL lock flag, which needs more than
+// a plain variable.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include "hal.h"
+
+#define CLK_MASK                (_BV(CS02) | _BV(CS01) | _BV(CS00))
+#define CLK_DIV1                _BV(CS00)
+#define CLK_DIV1024             (_BV(CS02) | _BV(CS00))
+
+// Bit 0 of TIFR is reserved: kept set in what the firmware sees, so a
+// write, which clears the flags written as one, can be told from a read
+#define TIFR_WRITTEN            _BV(0)
+
+static uint8_t _g_prescaler;               // PWM periods into the current /1024 count
+static uint8_t _g_flags;                   // Timer0 interrupt flags pending
+static volatile uint8_t _g_tifr;           // TIFR as the firmware reads and writes it
+
+static void tifr_sync(void)
+{
+    if (!(_g_tifr & TIFR_WRITTEN))
+        _g_flags &= ~_g_tifr;
+
+    _g_tifr = _g_flags | TIFR_WRITTEN;
+}
+
+volatile uint8_t *host_tifr(void)
+{
+    tifr_sync();
+    return &_g_tifr;
+}
+
+volatile uint8_t *host_pllcsr(void)
+{
+    static volatile uint8_t pllcsr;
+
+    if (pllcsr & _BV(PLLE))
+        pllcsr |= _BV(PLOCK);
+    else
+        pllcsr &= ~_BV(PLOCK);
+
+    return &pllcsr;
+}
+
+static bool service(uint8_t flag, uint8_t enable, void (*isr)(void))
+{
+    tifr_sync();
+
+    if (!(_g_flags & flag) || !(TIMSK & enable))
+        return false;
+
+    _g_flags &= ~flag;
+    tifr_sync();
+    isr();
+
+    return true;
+}
+
+// One PWM period, setting the flags that come due
+static void advance(void)
+{
+    switch (TCCR0B & CLK_MASK)
+    {
+        case CLK_DIV1:
+            // A full count: every compare matches once, then the overflow
+            _g_flags |= _BV(OCF0A) | _BV(OCF0B) | _BV(TOV0);
+            break;
+
+        case CLK_DIV1024:
+            if (++_g_prescaler < 1024 / 256)
+                break;
+
+            _g_prescaler = 0;
+
+            if (TCNT0 == OCR0A)
+                _g_flags |= _BV(OCF0A);
+
+            if (TCNT0 == OCR0B)
+                _g_flags |= _BV(OCF0B);
+
+            if (++TCNT0 == 0)
+                _g_flags |= _BV(TOV0);
+            break;
+    }
+}
+
+// Returns true if an interrupt ran, i.e. the CPU would have woken up
+bool host_timer0_tick(void)
+{
+    bool fired = false;
+
+    tifr_sync();
+    advance();
+
+    // In vector order
+    fired |= service(_BV(TOV0), _BV(TOIE0), TIMER0_OVF_vect);
+    fired |= service(_BV(OCF0A), _BV(OCIE0A), TIMER0_COMPA_vect);
+    fired |= service(_BV(OCF0B), _BV(OCIE0B), TIMER0_COMPB_vect);
+
+    tifr_sync();
+
+    return fired;
+}
+
+// At F_CPU/1024, PWM periods until the count moves on from the given one,
+// which is when the flags of a match or the overflow are set
+static uint32_t periods_past(uint8_t count)
+{
+    return 1024 / 256 - _g_prescaler + (uint8_t)(count - TCNT0) * (1024 / 256);
+}
+
+// PWM periods until host_timer0_tick() next runs an interrupt, counting
+// the one that does; UINT32_MAX if none is enabled
+uint32_t host_timer0_wake(void)
+{
+    uint32_t wake = UINT32_MAX;
+    uint8_t enabled = 0;
+
+    tifr_sync();
+
+    if (TIMSK & _BV(TOIE0))
+        enabled |= _BV(TOV0);
+
+    if (TIMSK & _BV(OCIE0A))
+        enabled |= _BV(OCF0A);
+
+    if (TIMSK & _BV(OCIE0B))
+        enabled |= _BV(OCF0B);
+
+    if (!enabled)
+        return UINT32_MAX;
+
+    if (_g_flags & enabled)
+        return 1;
+
+    switch (TCCR0B & CLK_MASK)
+    {
+        case CLK_DIV1:
+            return 1;
+
+        case CLK_DIV1024:
+            if (enabled & _BV(TOV0))
+                wake = periods_past(UINT8_MAX);
+
+            if ((enabled & _BV(OCF0A)) && periods_past(OCR0A) < wake)
+                wake = periods_past(OCR0A);
+
+            if ((enabled & _BV(OCF0B)) && periods_past(OCR0B) < wake)
+                wake = periods_past(OCR0B);
+            break;
+    }
+
+    return wake;
+}
+
+// Runs Timer0 for the given number of PWM periods, which must be fewer
+// than host_timer0_wake(): no interrupt is due on the way
+void host_timer0_skip(uint32_t periods)
+{
+    uint32_t clocks;
+
+    tifr_sync();
+
+    switch (TCCR0B & CLK_MASK)
+    {
+        case CLK_DIV1:
+            if (periods)
+                _g_flags |= _BV(OCF0A) | _BV(OCF0B) | _BV(TOV0);
+            break;
+
+        case CLK_DIV1024:
+            // The counts moved on from are TCNT0 up to TCNT0 + clocks - 1
+            clocks = (_g_prescaler + periods) / (1024 / 256);
+            _g_prescaler = (_g_prescaler + periods) % (1024 / 256);
+
+            if ((uint8_t)(OCR0A - TCNT0) < clocks)
+                _g_flags |= _BV(OCF0A);
+
+            if ((uint8_t)(OCR0B - TCNT0) < clocks)
+                _g_flags |= _BV(OCF0B);
+
+            if ((uint8_t)(UINT8_MAX - TCNT0) < clocks)
+                _g_flags |= _BV(TOV0);
+
+            TCNT0 += clocks;
+            break;
+    }
+
+    tifr_sync();
+}
@@ -0,0 +1,206 @@
+//*****************************************************************************
+// Title        : Event trace decoder
+// Author       : agent
+// Created      : 2026-10-16
+//
+// Part of the pulse to tone (DTMF) converter.
+//
+// This code is distributed under the GNU Public License
+// which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+// Decodes an event trace sent by a TRACE_RING / TRACE_UART build (L2-2,
+// see ../trace.h) into a timeline.
+//
+//   tracedump [file]
+//
+// Reads the raw serial capture (stdin without a file), for example
+//
+//   stty -F /dev/ttyUSB0 9600 raw && cat /dev/ttyUSB0 > dial.trace
+//
+// and decodes every frame in it; anything between frames is skipped.
+// Times are from the oldest event. The tick count is 16 bits, so a gap of
+// more than 65535 ticks (4.2 s at 4MHz) between two events shows up that
+// much shorter. Exits non zero if no frame decodes or a checksum fails.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../menu.h"
+#include "../trace.h"
+
+#define MAX_CAPTURE         65536
+#define HEADER_SIZE         5       // magic, count, ticks per second
+#define ENTRY_SIZE          4
+
+static const char *const _g_state_names[STATE_COUNT] =
+{
+    "dial", "L1", "L2", "program", "timing slot", "timing profile", "redial history"
+};
+
+static const char *const _g_sound_names[] =
+{
+    "0", "1", "2", "3", "4", "5", "6", "7", "8", "9", "*", "#",
+    "beep", "low beep", "ascending tune", "descending tune"
+};
+
+static const char *const _g_eeprom_names[] =
+{
+    "speed dial, through the journal", "redial log", "playback timing", "journal recovered"
+};
+
+static void print_event(uint8_t event, uint8_t arg)
+{
+    switch (event)
+    {
+        case TR_BOOT:
+            printf("boot, MCUSR 0x%02x%s%s%s%s", arg, arg & 0x01 ? " power on" : "",
+                arg & 0x02 ? " external" : "", arg & 0x04 ? " brown out" : "", arg & 0x08 ? " watchdog" : "");
+            break;
+        case TR_EDGE:
+            printf("INT0, pulse contact %s", arg ? "open" : "closed");
+            break;
+        case TR_PULSE:
+            if (arg == TR_PULSE_LOST)
+                printf("edges lost, digit void");
+            else
+                printf("pulse %u", arg);
+            break;
+        case TR_DIAL:
+            printf("dial %s", arg ? "at rest" : "off normal");
+            break;
+        case TR_DIGIT:
+            printf("digit complete, %u pulses", arg);
+            break;
+        case TR_STATE:
+        {
+            uint8_t ev = arg >> 4;
+            uint8_t state = arg & 0x0F;
+
+            if (ev < 10)
+                printf("dialed %u", ev);
+            else
+                printf("%s", ev == EV_HOLD ? "held" : ev == EV_IDLE ? "idle at rest" : "event ?");
+
+            printf(" -> %s", state < STATE_COUNT ? _g_state_names[state] : "?");
+            break;
+        }
+        case TR_WDT:
+            printf("watchdog");
+            break;
+        case TR_TONE:
+            printf("tone %s", arg < sizeof(_g_sound_names) / sizeof(_g_sound_names[0]) ? _g_sound_names[arg] : "silent");
+            break;
+        case TR_TONE_END:
+            printf("tones done%s", arg ? ", cut short" : "");
+            break;
+        case TR_EEPROM:
+            printf("EEPROM write, %s", arg < sizeof(_g_eeprom_names) / sizeof(_g_eeprom_names[0]) ? _g_eeprom_names[arg] : "?");
+            break;
+        default:
+            printf("unknown event 0x%02x, 0x%02x", event, arg);
+            break;
+    }
+
+    printf("\n");
+}
+
+// Decodes the frame at buf, returns its length or 0 if it isn't a whole one
+static size_t decode_frame(const uint8_t *buf, size_t len, bool *bad_check)
+{
+    uint8_t count;
+    unsigned ticks_per_s;
+    size_t frame_len;
+    uint8_t check = 0;
+    uint32_t time = 0;
+    uint16_t prev = 0;
+
+    if (len < HEADER_SIZE + 1)
+        return 0;
+
+    count = buf[2];
+    ticks_per_s = buf[3] | (buf[4] << 8);
+    frame_len = HEADER_SIZE + ENTRY_SIZE * count + 1;
+
+    if (frame_len > len || !ticks_per_s)
+        return 0;
+
+    for (size_t i = 2; i < frame_len; i++)
+        check ^= buf[i];
+
+    *bad_check = check != 0;
+    printf("Trace of %u events, %u ticks/s%s\n", count, ticks_per_s, check ? ", CHECKSUM WRONG" : "");
+    printf("   time_ms  delta_ms  event\n");
+
+    for (int i = 0; i < count; i++)
+    {
+        const uint8_t *entry = &buf[HEADER_SIZE + ENTRY_SIZE * i];
+        uint16_t ticks = entry[0] | (entry[1] << 8);
+        uint16_t delta = i ? (uint16_t)(ticks - prev) : 0;
+
+        time += delta;
+        prev = ticks;
+
+        printf("%10.3f", time * 1000.0 / ticks_per_s);
+
+        if (i)
+            printf("  %8.3f  ", delta * 1000.0 / ticks_per_s);
+        else
+            printf("            ");
+
+        print_event(entry[2], entry[3]);
+    }
+
+    return frame_len;
+}
+
+int main(int argc, char **argv)
+{
+    FILE *f = argc > 1 ? fopen(argv[1], "rb") : stdin;
+    static uint8_t buf[MAX_CAPTURE];
+    size_t len;
+    int frames = 0;
+    int bad = 0;
+
+    if (argc > 2)
+    {
+        fprintf(stderr, "Usage: tracedump [file]\n");
+        return 2;
+    }
+
+    if (!f)
+    {
+        perror(argv[1]);
+        return 2;
+    }
+
+    len = fread(buf, 1, sizeof(buf), f);
+
+    for (size_t i = 0; i + 1 < len; i++)
+    {
+        bool bad_check = false;
+        size_t frame_len;
+
+        if (memcmp(&buf[i], TRACE_MAGIC, 2))
+            continue;
+
+        frame_len = decode_frame(&buf[i], len - i, &bad_check);
+
+        if (!frame_len)
+            continue;
+
+        frames++;
+        bad += bad_check;
+        i += frame_len - 1;
+        printf("\n");
+    }
+
+    if (!frames)
+        fprintf(stderr, "No trace found\n");
+
+    return !frames || bad ? 1 : 0;
+}
@@ -0,0 +1,24 @@
+//*****************************************************************************
+// Title        : Host stand-in for <util/atomic.h>
+// Author       : agent
+// Created      : 2026-10-16
+//
+// Part of the pulse to tone (DTMF) converter.
+//
+// This code is distributed under the GNU Public License
+// which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+// Host stand-in for <util/atomic.h>. Interrupts are only ever delivered
+// from inside host_sleep(), so every block is already atomic.
+
+#ifndef __HOST_UTIL_ATOMIC_H__
+#define __HOST_UTIL_ATOMIC_H__
+
+#define ATOMIC_RESTORESTATE     0
+#define ATOMIC_FORCEON          1
+
+#define ATOMIC_BLOCK(type)      for (int __atomic_once = 1; __atomic_once; __atomic_once = 0)
+
+#endif /* __HOST_UTIL_ATOMIC_H__ */
@@ -0,0 +1,21 @@
+//*****************************************************************************
+// Title        : Host stand-in for <util/delay.h>
+// Author       : agent
+// Created      : 2026-10-16
+//
+// Part of the pulse to tone (DTMF) converter.
+//
+// This code is distributed under the GNU Public License
+// which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+// Host stand-in for <util/delay.h>. Busy waits take no simulated time.
+
+#ifndef __HOST_UTIL_DELAY_H__
+#define __HOST_UTIL_DELAY_H__
+
+#define _delay_ms(ms)           ((void)0)
+#define _delay_us(us)           ((void)0)
+
+#endif /* __HOST_UTIL_DELAY_H__ */
@@ -0,0 +1,26 @@
+//*****************************************************************************
+// Title        : Host stand-in for <util/delay_basic.h>
+// Author       : agent
+// Created      : 2026-10-16
+//
+// Part of the pulse to tone (DTMF) converter.
+//
+// This code is distributed under the GNU Public License
+// which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+// Host stand-in for <util/delay_basic.h>. The model sees each delay loop
+// as one call, which is how the bit banged trace output (trace.c) is read
+// back: host_delay_loop() samples the pins.
+
+#ifndef __HOST_UTIL_DELAY_BASIC_H__
+#define __HOST_UTIL_DELAY_BASIC_H__
+
+#include <stdint.h>
+
+void host_delay_loop(uint16_t count);
+
+#define _delay_loop_2(count)    host_delay_loop(count)
+
+#endif /* __HOST_UTIL_DELAY_BASIC_H__ */
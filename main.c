@@ -29,37 +29,60 @@
 #include <avr/io.h>
 #include <avr/interrupt.h>
 #include <avr/sleep.h>
-#include <avr/wdt.h>
 #include <util/delay.h>
 #include <avr/eeprom.h>
+#include <avr/pgmspace.h>
 
 #include "dtmf.h" 
+#include "digits.h"
+#include "redial.h"
+#include "pulse.h"
+#include "menu.h"
+#include "timer.h"
+#include "trace.h"
+
+// System clock prescaler: F_CPU = F_XTAL / 2^CLOCK_PRESCALE
+#ifndef F_XTAL
+#define F_XTAL                      F_CPU
+#endif
 
-#define PIN_DIAL                    PB1
-#define PIN_PULSE                   PB2
+#if F_XTAL == F_CPU
+#define CLOCK_PRESCALE              0
+#elif F_XTAL == 2 * F_CPU
+#define CLOCK_PRESCALE              1
+#elif F_XTAL == 4 * F_CPU
+#define CLOCK_PRESCALE              2
+#elif F_XTAL == 8 * F_CPU
+#define CLOCK_PRESCALE              3
+#else
+#error "F_CPU must be F_XTAL divided by 1, 2, 4 or 8"
+#endif
 
-#define SPEED_DIAL_SIZE             32
+#define PIN_DIAL                    PB1
 
-#define STATE_DIAL                  0x00
-#define STATE_SPECIAL_L1            0x01
-#define STATE_SPECIAL_L2            0x02
-#define STATE_PROGRAM_SD            0x03
+#define SPEED_DIAL_SIZE             DIGITS_MAX
 
 #define F_NONE                      0x00
-#define F_DETECT_SPECIAL_L1         0x01
-#define F_DETECT_SPECIAL_L2         0x02
+#define F_DETECT_HOLD               0x01
 #define F_WDT_AWAKE                 0x04
-
-#define SLEEP_64MS                  0x00
-#define SLEEP_128MS                 0x01
-#define SLEEP_2S                    0x02
+#define F_COMMIT_WAKE               0x08    // woken only to commit staged digits
 
 #define SPEED_DIAL_COUNT            8 // 8 Positions in total (Redail(3),4,5,6,7,8,9,0)
 #define SPEED_DIAL_REDIAL           (SPEED_DIAL_COUNT - 1)
 
-#define L2_STAR                     1
-#define L2_POUND                    2
-#define L2_REDIAL                   3
+#define L1_REDIAL                   3
+
+#define JOURNAL_EMPTY               0xFF
+
+// Speed dial playback timing (tone on / pause, ms, multiples of
+// DTMF_QUEUE_UNIT_MS), selected per position. 40/40 is the Q.24 minimum
+#define TIMING_PROFILE_COUNT        4
+
+typedef struct
+{
+    uint8_t on_ms;
+    uint8_t off_ms;
+} timing_profile_t;
 
 typedef struct
 {
@@ -68,20 +91,24 @@ typedef struct
     bool dial_pin_state;
     uint8_t speed_dial_index;
     uint8_t speed_dial_digit_index;
-    int8_t speed_dial_digits[SPEED_DIAL_SIZE];
+    uint8_t speed_dial_digits[DIGITS_PACKED_SIZE]; // packed, see digits.h
     int8_t dialed_digit;
+    int8_t commit_index;                    // position speed_dial_digits is staged for, -1 if none
 } runstate_t;
 
 static void init(void);
-static void process_dialed_digit(runstate_t *rs);
-static void dial_speed_dial_number(int8_t *speed_dial_digits, int8_t index);
-static void write_current_speed_dial(int8_t *speed_dial_digits, int8_t index);
-static void wdt_timer_start(uint8_t delay);
+static void dial_event(runstate_t *rs, uint8_t event);
+static void run_action(runstate_t *rs, uint8_t action);
+static void dial_speed_dial_number(uint8_t *speed_dial_digits, int8_t index);
+static void play_number(const uint8_t *speed_dial_digits, int8_t index);
+static void write_current_speed_dial(runstate_t *rs, int8_t index);
+static void commit_speed_dial(runstate_t *rs);
+static void recover_speed_dial(void);
+static int8_t speed_dial_position(int8_t digit);
 static void start_sleep(void);
-static void wdt_stop(void);
 
 // Map speed dial numbers to memory locations
-const int8_t _g_speed_dial_loc[] =
+const int8_t _g_speed_dial_loc[] PROGMEM =
 {
     0,
     -1 /* 1 - * */,
@@ -95,8 +122,27 @@ const int8_t _g_speed_dial_loc[] =
     6 
 };
 
-int8_t EEMEM _g_speed_dial_eeprom[SPEED_DIAL_COUNT][SPEED_DIAL_SIZE] = { [0 ... (SPEED_DIAL_COUNT - 1)][0 ... SPEED_DIAL_SIZE - 1] = DIGIT_OFF };
+// Dialed 1-4 after L2-1-<position>
+const timing_profile_t _g_timing_profiles[TIMING_PROFILE_COUNT] PROGMEM =
+{
+    { 100, 100 },   // 1 - standard
+    { 80, 80 },     // 2
+    { 60, 60 },     // 3
+    { 40, 40 },     // 4 - fastest the exchange must accept
+};
+
+// The redial position lives in the wear leveled log in redial.c
+uint8_t EEMEM _g_speed_dial_eeprom[SPEED_DIAL_REDIAL][DIGITS_PACKED_SIZE] = { [0 ... (SPEED_DIAL_REDIAL - 1)][0 ... DIGITS_PACKED_SIZE - 1] = DIGITS_PACKED_EMPTY };
+uint8_t EEMEM _g_speed_dial_timing_eeprom[SPEED_DIAL_COUNT] = { [0 ... (SPEED_DIAL_COUNT - 1)] = 0 };
+
+// Commit journal: the digits are written here first, then the marker is set
+// to the position they are for, then the position itself is written and the
+// marker cleared. Power lost at any point leaves either the old number or a
+// journal that recover_speed_dial() copies over at the next start up
+uint8_t EEMEM _g_journal_digits_eeprom[DIGITS_PACKED_SIZE];
+uint8_t EEMEM _g_journal_marker_eeprom = JOURNAL_EMPTY;
 runstate_t _g_run_state;
+static volatile bool _g_wake_event;         // set by every interrupt except Timer0 and INT0
 
 int main(void)
 {
@@ -104,12 +150,11 @@ int main(void)
     bool dial_pin_prev_state;
 
     init();
+    TRACE(TR_BOOT, MCUSR);
 
-    // Wait for the decoupling capacitors to charge
-    wdt_timer_start(SLEEP_128MS);
-    start_sleep();
-    wdt_stop();
-
+    // Pulses are counted straight away, the phone is often powered by
+    // lifting the handset and the first digit may already be on its way.
+    // Only the tone output waits for the supply, see dtmf_init()
     dtmf_init();
 
     // Local dial status variables 
@@ -118,25 +163,36 @@ int main(void)
     rs->flags = F_NONE;
     rs->speed_dial_digit_index = 0;
     rs->speed_dial_index = 0;
+    rs->commit_index = -1;
     dial_pin_prev_state = true;
+
+    recover_speed_dial();
+    redial_init();
     
-    for (uint8_t i = 0; i < SPEED_DIAL_SIZE; i++)
-        rs->speed_dial_digits[i] = DIGIT_OFF;
+    for (uint8_t i = 0; i < DIGITS_PACKED_SIZE; i++)
+        rs->speed_dial_digits[i] = DIGITS_PACKED_EMPTY;
 
     while (1)
     {
+        // Any interrupt from here on cuts the sleeps below short, so a dial
+        // pin change during one of them is never slept through
+        _g_wake_event = false;
         rs->dial_pin_state = bit_is_set(PINB, PIN_DIAL);
 
         if (dial_pin_prev_state != rs->dial_pin_state) 
         {
+            TRACE(TR_DIAL, rs->dial_pin_state);
+
             if (!rs->dial_pin_state) 
             {
-                // Dial just started
+                // Dial just started. Pulses are counted even while tones
+                // are still playing from the queue
                 // Enable special function detection
-                rs->flags |= F_DETECT_SPECIAL_L1;
+                rs->flags |= F_DETECT_HOLD;
                 rs->dialed_digit = 0;
+                pulse_start();
 
-                wdt_timer_start(SLEEP_64MS);
+                timer_wdt_start(WDT_64MS);
                 start_sleep();
             }
             else 
@@ -144,15 +200,35 @@ int main(void)
                 // Disable SF detection (should be already disabled)
                 rs->flags = F_NONE;
 
+                // The digit is complete as soon as no further pulse can
+                // come, going by the rate and break/make ratio measured
+                // on this dial
+                pulse_rest();
+
+                while (pulse_count() && !pulse_ready())
+                {
+                    // Sleep through rest contact bounce
+                    _g_wake_event = false;
+                    start_sleep();
+                }
+
+                // A count from a ring that dropped edges is worse than
+                // none: the digit is left out rather than dialed wrong
+                rs->dialed_digit = pulse_lost() ? 0 : pulse_count();
+                TRACE(TR_DIGIT, rs->dialed_digit);
+                pulse_stop();
+                timer_wdt_stop();
+
                 // Check that we detect a valid digit
                 if (rs->dialed_digit <= 0 || rs->dialed_digit > 10)
                 {
-                    // Should never happen - no pulses detected OR count more than 10 pulses
+                    // Should never happen - no pulses detected, edges lost OR count more than 10 pulses
                     rs->dialed_digit = DIGIT_OFF;                    
                     
                     // Do nothing
-                    wdt_timer_start(SLEEP_64MS);
+                    timer_wdt_start(WDT_64MS);
                     start_sleep();
+                    timer_wdt_stop();
                 }
                 else 
                 {
@@ -164,11 +240,7 @@ int main(void)
                     if (rs->dialed_digit == 10)
                         rs->dialed_digit = 0; // 10 pulses => 0
 #endif
-                    wdt_timer_start(SLEEP_128MS);
-                    start_sleep();
-                    wdt_stop();
-
-                    process_dialed_digit(rs);
+                    dial_event(rs, rs->dialed_digit);
                 }
             }    
         } 
@@ -177,186 +249,324 @@ int main(void)
             if (rs->dial_pin_state) 
             {
                 // Rotary dial at the rest position
-                // Reset all variables
-                rs->state = STATE_DIAL;
+                // Reset all variables. The watchdog that commits staged
+                // digits doesn't end a menu: a number being programmed
+                // may well pause for longer than that
+                if (!(rs->flags & F_COMMIT_WAKE))
+                    dial_event(rs, EV_IDLE);
+
                 rs->flags = F_NONE;
                 rs->dialed_digit = DIGIT_OFF;
+                pulse_stop();
             }
         }
 
         dial_pin_prev_state = rs->dial_pin_state;
 
+        // Moved again while the digit was being handled
+        if (rs->dial_pin_state != (bool)bit_is_set(PINB, PIN_DIAL))
+            continue;
+
         // Don't power down if special function detection is active        
-        if (rs->flags & F_DETECT_SPECIAL_L1)
+        if (rs->flags & F_DETECT_HOLD)
         {
             // Put MCU to sleep - to be awoken either by pin interrupt or WDT
-            wdt_timer_start(SLEEP_2S);
+            rs->flags &= ~F_WDT_AWAKE;
+            timer_wdt_start(WDT_2S);
             start_sleep();
 
+            // Pulses mean the dial was simply wound up, disable SF detection
+            if (pulse_count())
+                rs->flags = F_NONE;
+
             // Special function mode detected?
             if (rs->flags & F_WDT_AWAKE)
             {
-                // SF mode detected
                 rs->flags &= ~F_WDT_AWAKE;
-                rs->state = STATE_SPECIAL_L1;
-                rs->flags &= ~F_DETECT_SPECIAL_L1;
-                rs->flags |= F_DETECT_SPECIAL_L2;
+                dial_event(rs, EV_HOLD);
 
-                // Indicate that we entered L1 SF mode with short beep
-                dtmf_generate_tone(DIGIT_BEEP_LOW, 200);
+                // Only L1 leads further, to L2 after another 2s
+                if (rs->state != STATE_SPECIAL_L1)
+                    rs->flags &= ~F_DETECT_HOLD;
             }
         }
-        else if (rs->flags & F_DETECT_SPECIAL_L2)
+        else if (rs->commit_index >= 0)
         {
-            // Put MCU to sleep - to be awoken either by pin interrupt or WDT
-            wdt_timer_start(SLEEP_2S);
+            // Staged digits are written once the dial has been left alone
+            // for a while (and no tone needs the main loop), keeping EEPROM
+            // stalls out of the way while a number is being dialed
+            timer_wdt_start(WDT_2S);
             start_sleep();
+            timer_wdt_stop();
 
             if (rs->flags & F_WDT_AWAKE)
             {
-                // SF mode detected
-                rs->flags &= ~F_WDT_AWAKE;
-                rs->state = STATE_SPECIAL_L2;
-                rs->flags &= ~F_DETECT_SPECIAL_L2;
+                rs->flags = F_COMMIT_WAKE;
 
-                // Indicate that we entered L2 SF mode with asc tone
-                dtmf_generate_tone(DIGIT_TUNE_ASC, 200);
+                if (rs->dial_pin_state && !dtmf_busy())
+                    commit_speed_dial(rs);
             }
         }
         else
         {
-            // Don't need timer - sleep to power down mode
-            set_sleep_mode(SLEEP_MODE_PWR_DOWN);
-            sleep_mode();
+            // Don't need timer - sleep to power down mode (once the tones are out)
+            start_sleep();
         }
     }
 
     return 0;
 }
 
-static void process_dialed_digit(runstate_t *rs)
+// Move the state machine on; the table in menu.c says what to do
+static void dial_event(runstate_t *rs, uint8_t event)
 {
-    if (rs->state == STATE_DIAL)
-    {
-        // Standard (no speed dial, no special function) mode
-        // Generate DTMF code
-        dtmf_generate_tone(rs->dialed_digit, DTMF_DURATION_MS);
+    uint8_t entry = menu_lookup(rs->state, event);
 
-        if (rs->speed_dial_digit_index < SPEED_DIAL_SIZE)
-        {
-            // During regular dial always save into the 'Redial' position of the speed dial memory
-            rs->speed_dial_digits[rs->speed_dial_digit_index] = rs->dialed_digit;
-            rs->speed_dial_digit_index++;
-            
-            write_current_speed_dial(rs->speed_dial_digits, SPEED_DIAL_REDIAL);
-        }
-    }
-    else if (rs->state == STATE_SPECIAL_L1)
+    rs->state = MENU_NEXT(entry);
+    TRACE(TR_STATE, (event << 4) | rs->state);
+    run_action(rs, MENU_ACTION(entry));
+}
+
+static void run_action(runstate_t *rs, uint8_t action)
+{
+    switch (action)
     {
-        if (rs->dialed_digit == L2_STAR)
-        {
+        case A_TONE:
+            // Standard (no speed dial, no special function) mode
+            if (rs->speed_dial_digit_index < SPEED_DIAL_SIZE)
+            {
+                // During regular dial always save into the 'Redial' position of the speed dial memory
+                digits_set(rs->speed_dial_digits, rs->speed_dial_digit_index, rs->dialed_digit);
+                rs->speed_dial_digit_index++;
+
+                write_current_speed_dial(rs, SPEED_DIAL_REDIAL);
+            }
+
+            // Generate DTMF code
+            dtmf_queue_tone(rs->dialed_digit, DTMF_DURATION_MS, 0);
+            break;
+
+        case A_STAR:
             // SF 1-*
-            dtmf_generate_tone(DIGIT_STAR, DTMF_DURATION_MS);  
-            rs->state = STATE_DIAL;
-        }
-        else if (rs->dialed_digit == L2_POUND)
-        {
+            dtmf_queue_tone(DIGIT_STAR, DTMF_DURATION_MS, 0);
+            break;
+
+        case A_POUND:
             // SF 2-#
-            dtmf_generate_tone(DIGIT_POUND, DTMF_DURATION_MS);
-            rs->state = STATE_DIAL;
-        }
-        else if (rs->dialed_digit == L2_REDIAL)
-        {
-            // SF 3 (Redial)
-            dial_speed_dial_number(rs->speed_dial_digits, SPEED_DIAL_REDIAL);
-        }
-        else if (_g_speed_dial_loc[rs->dialed_digit] >= 0)
-        {
-            // Call speed dial number
-            dial_speed_dial_number(rs->speed_dial_digits, _g_speed_dial_loc[rs->dialed_digit]);
-        }
-    }
-    else if (rs->state == STATE_SPECIAL_L2)
-    {
-        if (_g_speed_dial_loc[rs->dialed_digit] >= 0)
-        {
-            rs->speed_dial_index = _g_speed_dial_loc[rs->dialed_digit];
+            dtmf_queue_tone(DIGIT_POUND, DTMF_DURATION_MS, 0);
+            break;
+
+        case A_SPEED_DIAL:
+            // SF 3 (Redial) or call speed dial number
+            commit_speed_dial(rs);
+            dial_speed_dial_number(rs->speed_dial_digits, speed_dial_position(rs->dialed_digit));
+            break;
+
+        case A_SPECIAL_L1:
+            // Holding the dial cancels any playback still queued
+            dtmf_abort();
+
+            // Indicate that we entered L1 SF mode with short beep
+            dtmf_queue_tone(DIGIT_BEEP_LOW, 200, 0);
+            break;
+
+        case A_SPECIAL_L2:
+            // Indicate that we entered L2 SF mode with asc tone
+            dtmf_queue_tone(DIGIT_TUNE_ASC, 200, 0);
+            break;
+
+        case A_PROGRAM:
+            // Anything staged for another position goes out first
+            commit_speed_dial(rs);
+
+            rs->speed_dial_index = pgm_read_byte(&_g_speed_dial_loc[rs->dialed_digit]);
             rs->speed_dial_digit_index = 0;
 
-            for (uint8_t i = 0; i < SPEED_DIAL_SIZE; i++)
-                rs->speed_dial_digits[i] = DIGIT_OFF;
+            for (uint8_t i = 0; i < DIGITS_PACKED_SIZE; i++)
+                rs->speed_dial_digits[i] = DIGITS_PACKED_EMPTY;
+            break;
 
-            rs->state = STATE_PROGRAM_SD;
-        }
-        else
-        {
-            // Not a speed dial position. Revert back to ordinary dial        
-            rs->state = STATE_DIAL;
-        }
-    }
-    else if (rs->state == STATE_PROGRAM_SD)
-    {
-        // Do we have too many digits entered?
-        if (rs->speed_dial_digit_index >= SPEED_DIAL_SIZE)
-        {
-            // Exit speed dial mode
-            rs->state = STATE_DIAL;
-            // Beep to indicate that we done
-            dtmf_generate_tone(DIGIT_TUNE_DESC, 800);
-        } 
-        else
-        {
-            // Next digit
-            rs->speed_dial_digits[rs->speed_dial_digit_index] = rs->dialed_digit;
-            rs->speed_dial_digit_index++;
+        case A_PROGRAM_DIGIT:
+            // Do we have too many digits entered?
+            if (rs->speed_dial_digit_index >= SPEED_DIAL_SIZE)
+            {
+                // Exit speed dial mode
+                rs->state = STATE_DIAL;
+            }
+            else
+            {
+                // Next digit
+                digits_set(rs->speed_dial_digits, rs->speed_dial_digit_index, rs->dialed_digit);
+                rs->speed_dial_digit_index++;
+            }
 
-            // Generic beep - do not gererate DTMF code
-            dtmf_generate_tone(DIGIT_BEEP_LOW, DTMF_DURATION_MS);
-        }
+            // Stage SD on every digit; committed once the dial is left alone
+            write_current_speed_dial(rs, rs->speed_dial_index);
 
-        // Write SD on every digit so user can hang up to save
-        write_current_speed_dial(rs->speed_dial_digits, rs->speed_dial_index);
+            if (rs->state == STATE_DIAL)
+            {
+                // Beep to indicate that we done
+                dtmf_queue_tone(DIGIT_TUNE_DESC, 800, 0);
+            }
+            else
+            {
+                // Generic beep - do not gererate DTMF code
+                dtmf_queue_tone(DIGIT_BEEP_LOW, DTMF_DURATION_MS, 0);
+            }
+            break;
+
+        case A_HISTORY_START:
+            // SF 3: redial an earlier number, the next digit says which
+            commit_speed_dial(rs);
+            dtmf_queue_tone(DIGIT_BEEP_LOW, DTMF_DURATION_MS, 0);
+            break;
+
+        case A_HISTORY:
+            if (redial_load_nth((rs->dialed_digit ? rs->dialed_digit : 10) - 1, rs->speed_dial_digits))
+                play_number(rs->speed_dial_digits, SPEED_DIAL_REDIAL);
+            break;
+
+        case A_TIMING_SLOT:
+            // SF 1: choose the playback timing of a position
+            rs->speed_dial_index = speed_dial_position(rs->dialed_digit);
+            dtmf_queue_tone(DIGIT_BEEP_LOW, DTMF_DURATION_MS, 0);
+            break;
+
+        case A_TIMING_PROFILE:
+            TRACE(TR_EEPROM, TR_EE_TIMING);
+            eeprom_update_byte(&_g_speed_dial_timing_eeprom[rs->speed_dial_index], rs->dialed_digit - 1);
+
+            // Beep to indicate that we done
+            dtmf_queue_tone(DIGIT_TUNE_DESC, 800, 0);
+            break;
+
+        case A_TRACE_DUMP:
+            // L2-2: send the event trace out of the tone pin (TRACE_UART
+            // builds only, see trace.h)
+            dtmf_wait();
+            trace_dump();
+            break;
     }
 }
 
 // Dial speed dial number (it erases current SD number in the global structure)
-static void dial_speed_dial_number(int8_t *speed_dial_digits, int8_t index)
+static void dial_speed_dial_number(uint8_t *speed_dial_digits, int8_t index)
 {
     if (index >= 0 && index < SPEED_DIAL_COUNT)
     {
-        eeprom_read_block(speed_dial_digits, &_g_speed_dial_eeprom[index][0], SPEED_DIAL_SIZE);
+        if (index == SPEED_DIAL_REDIAL)
+            redial_load(speed_dial_digits);
+        else
+            eeprom_read_block(speed_dial_digits, &_g_speed_dial_eeprom[index][0], DIGITS_PACKED_SIZE);
 
-        for (uint8_t i = 0; i < SPEED_DIAL_SIZE; i++)
-        {
-            // Dial the number
-            // Skip dialing invalid digits
-            if (speed_dial_digits[i] >= 0 && speed_dial_digits[i] <= DIGIT_POUND)
-            {
-                dtmf_generate_tone(speed_dial_digits[i], DTMF_DURATION_MS);  
-                // Pause between DTMF tones
-                sleep_ms(DTMF_DURATION_MS);    
-            }
-        }
+        play_number(speed_dial_digits, index);
     }
 }
 
-static void write_current_speed_dial(int8_t *speed_dial_digits, int8_t index)
+// Queue a packed number with the timing profile of position index
+static void play_number(const uint8_t *speed_dial_digits, int8_t index)
+{
+    uint8_t profile = eeprom_read_byte(&_g_speed_dial_timing_eeprom[index]);
+    uint8_t on_ms;
+    uint8_t off_ms;
+
+    // Erased EEPROM (0xFF) gets the standard timing
+    if (profile >= TIMING_PROFILE_COUNT)
+        profile = 0;
+
+    on_ms = pgm_read_byte(&_g_timing_profiles[profile].on_ms);
+    off_ms = pgm_read_byte(&_g_timing_profiles[profile].off_ms);
+
+    // Dialed up to its terminator, with a pause after every tone. Queued
+    // as a copy, so dialing can carry on while it plays
+    dtmf_queue_number(speed_dial_digits, on_ms, off_ms);
+}
+
+// Speed dial position for a dialed digit, including 3 for redial;
+// -1 if there is none
+static int8_t speed_dial_position(int8_t digit)
+{
+    if (digit == L1_REDIAL)
+        return SPEED_DIAL_REDIAL;
+
+    return (int8_t)pgm_read_byte(&_g_speed_dial_loc[digit]);
+}
+
+// Stage the digits in rs for a position. Nothing is written yet; see
+// commit_speed_dial()
+static void write_current_speed_dial(runstate_t *rs, int8_t index)
 {
     if (index >= 0 && index < SPEED_DIAL_COUNT)
     {
-        // If dialed index SPEED_DIAL_FIRST => using array index 0
-        eeprom_update_block(speed_dial_digits, &_g_speed_dial_eeprom[index][0], SPEED_DIAL_SIZE);
+        if (rs->commit_index >= 0 && rs->commit_index != index)
+            commit_speed_dial(rs);
+
+        rs->commit_index = index;
     }
 }
 
+// Write the staged digits through the journal. eeprom_update_block() only
+// rewrites bytes that changed, so a repeated number costs no wear
+static void commit_speed_dial(runstate_t *rs)
+{
+    if (rs->commit_index < 0)
+        return;
+
+    // The redial log is safe against power loss by itself
+    if (rs->commit_index == SPEED_DIAL_REDIAL)
+    {
+        TRACE(TR_EEPROM, TR_EE_REDIAL);
+        redial_save(rs->speed_dial_digits);
+        rs->commit_index = -1;
+        return;
+    }
+
+    TRACE(TR_EEPROM, TR_EE_SPEED_DIAL);
+    eeprom_update_block(rs->speed_dial_digits, _g_journal_digits_eeprom, DIGITS_PACKED_SIZE);
+    eeprom_update_byte(&_g_journal_marker_eeprom, rs->commit_index);
+
+    // If dialed index SPEED_DIAL_FIRST => using array index 0
+    eeprom_update_block(rs->speed_dial_digits, &_g_speed_dial_eeprom[rs->commit_index][0], DIGITS_PACKED_SIZE);
+    eeprom_update_byte(&_g_journal_marker_eeprom, JOURNAL_EMPTY);
+
+    rs->commit_index = -1;
+}
+
+// Finish a commit cut short by a power loss
+static void recover_speed_dial(void)
+{
+    uint8_t index = eeprom_read_byte(&_g_journal_marker_eeprom);
+    uint8_t digits[DIGITS_PACKED_SIZE];
+
+    if (index == JOURNAL_EMPTY)
+        return;
+
+    TRACE(TR_EEPROM, TR_EE_RECOVER);
+
+    // Brown out detection is off, so give the decoupling capacitors time
+    // to charge before writing. Only a start up that lost power part way
+    // through a commit pays for this
+    timer_wdt_start(WDT_128MS);
+    start_sleep();
+    timer_wdt_stop();
+
+    if (index < SPEED_DIAL_REDIAL)
+    {
+        eeprom_read_block(digits, _g_journal_digits_eeprom, DIGITS_PACKED_SIZE);
+        eeprom_update_block(digits, &_g_speed_dial_eeprom[index][0], DIGITS_PACKED_SIZE);
+    }
+
+    eeprom_update_byte(&_g_journal_marker_eeprom, JOURNAL_EMPTY);
+}
+
 static void init(void)
 {
-    // Program clock prescaller to divide + frequency by 1
+    // Program clock prescaller to divide + frequency by 2^CLOCK_PRESCALE
     // Write CLKPCE 1 and other bits 0    
     CLKPR = _BV(CLKPCE);
 
     // Write prescaler value with CLKPCE = 0
-    CLKPR = 0;
+    CLKPR = CLOCK_PRESCALE;
 
     // Enable pull-ups
     PORTB |= (_BV(PIN_DIAL) | _BV(PIN_PULSE));
@@ -366,49 +576,43 @@ static void init(void)
     ACSR = _BV(ACD);
 
     // Configure pin change interrupt
-    MCUCR = _BV(ISC01) | _BV(ISC00);         // Set INT0 for falling edge detection
+    MCUCR = _BV(ISC00);                      // Set INT0 for any edge, pulse.c timestamps both
     GIMSK = _BV(INT0) | _BV(PCIE);           // Added INT0
-    PCMSK = _BV(PIN_DIAL) | _BV(PIN_PULSE);
+    PCMSK = _BV(PIN_DIAL);
 
     // Enable interrupts
     sei();                              
 }
 
-static void wdt_timer_start(uint8_t delay)
+// Sleep until a dial pin change or the watchdog wakes us up, or a dialed
+// digit is complete. Returns straight away if either happened since the
+// main loop last looked at the dial. Queued tones and pulse timestamps need Timer0, so
+// while there are any tones or the dial is off normal only idle, and keep
+// both moving every time Timer0 wakes us: every PWM period while a tone
+// plays, otherwise at the deadlines they set
+static void start_sleep(void)
 {
-    wdt_reset();
-    cli();
-    MCUSR = 0x00;
-    WDTCR |= _BV(WDCE) | _BV(WDE);
-    switch (delay)
+    while (dtmf_busy() || pulse_active())
     {
-        case SLEEP_64MS:
-            WDTCR = _BV(WDIE) | _BV(WDP1);
-            break;
-        case SLEEP_128MS:
-            WDTCR = _BV(WDIE) | _BV(WDP1) | _BV(WDP0);
-            break;
-        case SLEEP_2S:
-            WDTCR = _BV(WDIE) | _BV(WDP0) | _BV(WDP1) | _BV(WDP2); // 2048ms
-            break;
-    }
-    sei();
-}
+        dtmf_poll();
+        pulse_poll();
 
-static void wdt_stop(void)
-{
-    wdt_reset();
-    cli();
-    MCUSR = 0x00;
-    WDTCR |= _BV(WDCE) | _BV(WDE);
-    WDTCR = 0x00;
-    sei();
-}
+        if (_g_wake_event || pulse_ready())
+            return;
+
+        timer_idle();
+    }
 
-static void start_sleep(void)
-{
     set_sleep_mode(SLEEP_MODE_PWR_DOWN);
     cli();                          // stop interrupts to ensure the BOD timed sequence executes as required
+
+    if (_g_wake_event)
+    {
+        // Woken while the last tone was finishing
+        sei();
+        return;
+    }
+
     sleep_enable();
     sleep_bod_disable();            // disable brown-out detection (good for 20-25µA)
     sei();                          // ensure interrupts enabled so we can wake up again
@@ -416,30 +620,22 @@ static void start_sleep(void)
     sleep_disable();                // wake up here
 }
 
-// Handler for external interrupt on INT0 (PB2, pin 7)
-ISR(INT0_vect)
-{
-    if (!_g_run_state.dial_pin_state)
-    {
-        // Disabling SF detection
-        _g_run_state.flags = F_NONE;
-        // A pulse just started
-        _g_run_state.dialed_digit++;
-    }
-}
-
 // Interrupt initiated by pin change on any enabled pin
 ISR(PCINT0_vect)
 {
+    _g_wake_event = true;
 }
 
 // Handler for any unspecified 'bad' interrupts
 ISR(BADISR_vect)
 {
     // Do nothing, just wake up MCU
+    _g_wake_event = true;
 }
 
 ISR(WDT_vect)
 {
+    TRACE(TR_WDT, 0);
+    _g_wake_event = true;
     _g_run_state.flags |= F_WDT_AWAKE;
 }
\ No newline at end of file
@@ -0,0 +1,94 @@
+//*****************************************************************************
+// Title        : Dial state machine
+// Author       : agent
+// Created      : 2026-10-16
+//
+// Part of the pulse to tone (DTMF) converter.
+//
+// This code is distributed under the GNU Public License
+// which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <avr/pgmspace.h>
+
+#include "menu.h"
+
+#define T(action, next)             (((action) << 4) | (next))
+
+#if A_COUNT > 16 || STATE_COUNT > 16
+#error "Table entries hold the action and next state in a nibble each"
+#endif
+
+// Columns are the digits 0-9, EV_HOLD and EV_IDLE. Holding the dial
+// starts the special functions from any state; waking at rest with
+// nothing dialed ends any menu
+static const uint8_t _g_menu_table[STATE_COUNT][EV_COUNT] PROGMEM =
+{
+    [STATE_DIAL] =
+    {
+        [0 ... 9] = T(A_TONE, STATE_DIAL),
+        [EV_HOLD] = T(A_SPECIAL_L1, STATE_SPECIAL_L1),
+        [EV_IDLE] = T(A_NONE, STATE_DIAL),
+    },
+    // L1: 1 *, 2 #, 3 redial, 4-9 and 0 speed dial
+    [STATE_SPECIAL_L1] =
+    {
+        [0] = T(A_SPEED_DIAL, STATE_DIAL),
+        [1] = T(A_STAR, STATE_DIAL),
+        [2] = T(A_POUND, STATE_DIAL),
+        [3 ... 9] = T(A_SPEED_DIAL, STATE_DIAL),
+        [EV_HOLD] = T(A_SPECIAL_L2, STATE_SPECIAL_L2),
+        [EV_IDLE] = T(A_NONE, STATE_DIAL),
+    },
+    // L2: 1 playback timing, 2 event trace, 3 redial history, 4-9 and 0
+    // program a position
+    [STATE_SPECIAL_L2] =
+    {
+        [0] = T(A_PROGRAM, STATE_PROGRAM_SD),
+        [1] = T(A_NONE, STATE_TIMING_SLOT),
+        [2] = T(A_TRACE_DUMP, STATE_DIAL),
+        [3] = T(A_HISTORY_START, STATE_REDIAL_HISTORY),
+        [4 ... 9] = T(A_PROGRAM, STATE_PROGRAM_SD),
+        [EV_HOLD] = T(A_NONE, STATE_SPECIAL_L2),
+        [EV_IDLE] = T(A_NONE, STATE_DIAL),
+    },
+    [STATE_PROGRAM_SD] =
+    {
+        [0 ... 9] = T(A_PROGRAM_DIGIT, STATE_PROGRAM_SD),
+        [EV_HOLD] = T(A_SPECIAL_L1, STATE_SPECIAL_L1),
+        [EV_IDLE] = T(A_NONE, STATE_DIAL),
+    },
+    // Positions are 3 (redial), 4-9 and 0
+    [STATE_TIMING_SLOT] =
+    {
+        [0] = T(A_TIMING_SLOT, STATE_TIMING_PROFILE),
+        [1 ... 2] = T(A_NONE, STATE_DIAL),
+        [3 ... 9] = T(A_TIMING_SLOT, STATE_TIMING_PROFILE),
+        [EV_HOLD] = T(A_SPECIAL_L1, STATE_SPECIAL_L1),
+        [EV_IDLE] = T(A_NONE, STATE_DIAL),
+    },
+    // Profiles 1-4, see _g_timing_profiles
+    [STATE_TIMING_PROFILE] =
+    {
+        [0] = T(A_NONE, STATE_DIAL),
+        [1 ... 4] = T(A_TIMING_PROFILE, STATE_DIAL),
+        [5 ... 9] = T(A_NONE, STATE_DIAL),
+        [EV_HOLD] = T(A_SPECIAL_L1, STATE_SPECIAL_L1),
+        [EV_IDLE] = T(A_NONE, STATE_DIAL),
+    },
+    // 1 is the last number, 0 the tenth last
+    [STATE_REDIAL_HISTORY] =
+    {
+        [0 ... 9] = T(A_HISTORY, STATE_DIAL),
+        [EV_HOLD] = T(A_SPECIAL_L1, STATE_SPECIAL_L1),
+        [EV_IDLE] = T(A_NONE, STATE_DIAL),
+    },
+};
+
+// Table entry for an event, see MENU_ACTION() and MENU_NEXT()
+uint8_t menu_lookup(uint8_t state, uint8_t event)
+{
+    return pgm_read_byte(&_g_menu_table[state][event]);
+}
@@ -0,0 +1,58 @@
+//*****************************************************************************
+// Title        : Dial state machine
+// Author       : agent
+// Created      : 2026-10-16
+//
+// Part of the pulse to tone (DTMF) converter.
+//
+// This code is distributed under the GNU Public License
+// which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+#ifndef __MENU_H__
+#define __MENU_H__
+
+// Dial state machine. Every event (a dialed digit, holding the dial or
+// waking at rest) in every state maps to one table entry in flash giving
+// the action main.c runs and the state that follows. An action may cut a
+// menu short by going back to STATE_DIAL, never anywhere else.
+
+#include <stdint.h>
+
+#define STATE_DIAL                  0x00
+#define STATE_SPECIAL_L1            0x01
+#define STATE_SPECIAL_L2            0x02
+#define STATE_PROGRAM_SD            0x03
+#define STATE_TIMING_SLOT           0x04
+#define STATE_TIMING_PROFILE        0x05
+#define STATE_REDIAL_HISTORY        0x06
+#define STATE_COUNT                 7
+
+// A dialed digit 0-9 is its own event
+#define EV_HOLD                     10      // Dial held off normal through a 2s window
+#define EV_IDLE                     11      // Woken at rest with nothing dialed (not to commit)
+#define EV_COUNT                    12
+
+#define A_NONE                      0
+#define A_TONE                      1       // DTMF tone, remembered for redial
+#define A_STAR                      2
+#define A_POUND                     3
+#define A_SPEED_DIAL                4       // Play the position dialed (3 = redial)
+#define A_SPECIAL_L1                5       // Cancel playback, low beep
+#define A_SPECIAL_L2                6       // Ascending tune
+#define A_PROGRAM                   7       // Start programming the position dialed
+#define A_PROGRAM_DIGIT             8
+#define A_HISTORY_START             9
+#define A_HISTORY                   10      // Play the n-th last number
+#define A_TIMING_SLOT               11      // Pick the position to set the timing of
+#define A_TIMING_PROFILE            12      // Store the timing profile dialed
+#define A_TRACE_DUMP                13      // Send the event trace (TRACE_UART builds)
+#define A_COUNT                     14
+
+#define MENU_ACTION(entry)          ((entry) >> 4)
+#define MENU_NEXT(entry)            ((entry) & 0x0F)
+
+uint8_t menu_lookup(uint8_t state, uint8_t event);
+
+#endif /* __MENU_H__ */
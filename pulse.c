@@ -0,0 +1,306 @@
+//*****************************************************************************
+// Title        : Pulse contact capture and debouncing
+// Author       : agent
+// Created      : 2026-10-16
+//
+// Part of the pulse to tone (DTMF) converter.
+//
+// This code is distributed under the GNU Public License
+// which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+
+#include "dds.h"
+#include "dtmf.h"
+#include "pulse.h"
+#include "timer.h"
+#include "trace.h"
+
+#define PULSE_LEVEL                 0x8000  // Ring entry: pin level after the edge
+#define PULSE_TIME_MASK             0x7FFF  // Ring entry: Timer0 ticks (wraps after 2s at 4MHz)
+
+#if PULSE_RING_SIZE & (PULSE_RING_SIZE - 1)
+#error "PULSE_RING_SIZE must be a power of two"
+#endif
+
+static uint16_t pulse_now(void);
+static void pulse_edge(uint16_t when, bool level);
+static uint16_t pulse_settle(uint16_t now);
+static uint16_t pulse_make_limit(void);
+
+static volatile uint16_t _g_ring[PULSE_RING_SIZE];
+static volatile uint8_t _g_ring_head;       // next entry INT0 writes
+static volatile uint8_t _g_ring_tail;       // next entry pulse_poll() reads
+static volatile bool _g_ring_overflow;      // INT0 found the ring full
+
+static bool _g_active;
+static bool _g_lost;                        // edges dropped since pulse_start()
+static uint8_t _g_count;                    // debounced breaks since pulse_start()
+static bool _g_stable;                      // debounced level, true = break
+static bool _g_raw;                         // level after the last edge
+static uint16_t _g_raw_since;               // and when it started
+static uint16_t _g_first_break;             // start of the first debounced break
+static uint16_t _g_last_break;              // start of the latest one
+static uint16_t _g_last_make;               // start of the latest debounced make
+static uint16_t _g_break_sum;               // ticks spent in completed breaks
+static bool _g_resting;                     // dial back at rest, settling
+static uint16_t _g_rest_since;
+
+// Dial left the rest position: count pulses from zero
+void pulse_start(void)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        // Edges from before are of no interest
+        _g_ring_tail = _g_ring_head;
+        _g_ring_overflow = false;
+        _g_raw_since = pulse_now();
+    }
+
+    _g_lost = false;
+
+    _g_raw = bit_is_set(PINB, PIN_PULSE);
+    _g_stable = _g_raw;
+    _g_count = 0;
+    _g_break_sum = 0;
+    _g_resting = false;
+    _g_active = true;
+}
+
+void pulse_stop(void)
+{
+    _g_active = false;
+    _g_resting = false;
+}
+
+// Dial back at the rest position. The count is final once no further
+// break can come, see pulse_ready()
+void pulse_rest(void)
+{
+    pulse_poll();
+
+    _g_rest_since = pulse_now();
+    _g_resting = true;
+}
+
+// True once the dial has been at rest long enough for the rest contact to
+// settle and the make after the last pulse has lasted as long as the
+// measured makes plus an eighth of a period. A dial that could not be
+// measured gets the make of the slowest one allowed
+bool pulse_ready(void)
+{
+    uint16_t now;
+    uint16_t rest;
+    uint16_t make;
+    uint16_t limit;
+
+    if (!_g_resting)
+        return false;
+
+    pulse_poll();
+    now = pulse_now();
+
+    rest = (now - _g_rest_since) & PULSE_TIME_MASK;
+    make = (now - _g_last_make) & PULSE_TIME_MASK;
+
+    if (rest < T0_OVERFLOWS(PULSE_MIN_MAKE_MS))
+    {
+        timer_wake_at(timer_now() + T0_OVERFLOWS(PULSE_MIN_MAKE_MS) - rest);
+        return false;
+    }
+
+    limit = _g_count ? pulse_make_limit() : 0;
+
+    if (make < limit)
+    {
+        timer_wake_at(timer_now() + limit - make);
+        return false;
+    }
+
+    return true;
+}
+
+// Measured pulse period in Timer0 ticks, 0 until two pulses are in
+uint16_t pulse_period(void)
+{
+    if (_g_count < 2)
+        return 0;
+
+    return ((_g_last_break - _g_first_break) & PULSE_TIME_MASK) / (_g_count - 1);
+}
+
+// Average break in Timer0 ticks, 0 until a pulse has completed
+uint16_t pulse_break(void)
+{
+    // Every break but a current one has completed
+    uint8_t breaks = _g_stable ? _g_count - 1 : _g_count;
+
+    if (!breaks)
+        return 0;
+
+    return _g_break_sum / breaks;
+}
+
+bool pulse_active(void)
+{
+    return _g_active;
+}
+
+// Debounce everything captured so far. Call on every wake up while
+// pulse_active(); a level is only accepted once it has held for its
+// minimum time, which pulse_settle() checks against the current time too,
+// asking for a wake up when it will have
+void pulse_poll(void)
+{
+    uint8_t tail;
+    uint16_t left;
+
+    if (_g_ring_overflow)
+    {
+        // A dropped edge swaps make and break for everything after it.
+        // Start again from the pin as it is now so the levels stay
+        // right; the count is not, so the digit is void (pulse_lost())
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        {
+            _g_ring_tail = _g_ring_head;
+            _g_ring_overflow = false;
+            _g_raw = bit_is_set(PINB, PIN_PULSE);
+            _g_raw_since = pulse_now();
+        }
+
+        _g_lost = true;
+        TRACE(TR_PULSE, TR_PULSE_LOST);
+    }
+
+    tail = _g_ring_tail;
+
+    while (tail != _g_ring_head)
+    {
+        uint16_t entry = _g_ring[tail];
+
+        pulse_edge(entry & PULSE_TIME_MASK, entry & PULSE_LEVEL);
+        tail = (tail + 1) & (PULSE_RING_SIZE - 1);
+        _g_ring_tail = tail;
+    }
+
+    left = pulse_settle(pulse_now());
+
+    if (left)
+        timer_wake_at(timer_now() + left);
+}
+
+// True if INT0 had to drop edges since pulse_start(): the count can't be
+// trusted and the digit must not be dialed
+bool pulse_lost(void)
+{
+    pulse_poll();
+
+    return _g_lost;
+}
+
+// Pulses counted since pulse_start()
+uint8_t pulse_count(void)
+{
+    pulse_poll();
+
+    return _g_count;
+}
+
+static uint16_t pulse_now(void)
+{
+    return timer_now() & PULSE_TIME_MASK;
+}
+
+static void pulse_edge(uint16_t when, bool level)
+{
+    // Did the level before this edge last long enough to count?
+    pulse_settle(when);
+
+    _g_raw = level;
+    _g_raw_since = when;
+}
+
+// Returns the ticks until the level after the last edge is accepted,
+// 0 once it has been (or there is nothing to accept)
+static uint16_t pulse_settle(uint16_t now)
+{
+    uint16_t held = (now - _g_raw_since) & PULSE_TIME_MASK;
+    uint16_t needed = _g_raw ? T0_OVERFLOWS(PULSE_MIN_BREAK_MS) : T0_OVERFLOWS(PULSE_MIN_MAKE_MS);
+
+    if (_g_raw == _g_stable)
+        return 0;
+
+    if (held < needed)
+        return needed - held;
+
+    _g_stable = _g_raw;
+
+    // A break is a pulse. Times are from the edge that started the
+    // level, not from when it was accepted
+    if (_g_stable)
+    {
+        if (!_g_count)
+            _g_first_break = _g_raw_since;
+
+        _g_last_break = _g_raw_since;
+
+        if (_g_count < UINT8_MAX)
+            _g_count++;
+
+        TRACE(TR_PULSE, _g_count);
+    }
+    else
+    {
+        _g_last_make = _g_raw_since;
+        _g_break_sum += (_g_last_make - _g_last_break) & PULSE_TIME_MASK;
+    }
+
+    return 0;
+}
+
+// How long the make after the last pulse must last before the digit is
+// complete, in Timer0 ticks
+static uint16_t pulse_make_limit(void)
+{
+    uint16_t period = pulse_period();
+    uint16_t brk = pulse_break();
+
+    if (period < T0_OVERFLOWS(1000 / PULSE_PPS_MAX) || period > T0_OVERFLOWS(1000 / PULSE_PPS_MIN) ||
+        !brk || brk >= period)
+    {
+        return T0_OVERFLOWS(PULSE_SETTLE_MAX_MS);
+    }
+
+    return period - brk + period / 8;
+}
+
+// Handler for external interrupt on INT0 (PB2, pin 7), both edges.
+// A full ring drops the edge and flags it for pulse_poll(); at 8 entries
+// that takes a burst of bounce faster than the main loop wakes up
+ISR(INT0_vect)
+{
+    uint8_t head = _g_ring_head;
+    uint8_t next = (head + 1) & (PULSE_RING_SIZE - 1);
+    uint16_t entry = timer_now() & PULSE_TIME_MASK;
+
+    if (bit_is_set(PINB, PIN_PULSE))
+        entry |= PULSE_LEVEL;
+
+    TRACE(TR_EDGE, (entry & PULSE_LEVEL) != 0);
+
+    if (next != _g_ring_tail)
+    {
+        _g_ring[head] = entry;
+        _g_ring_head = next;
+    }
+    else
+    {
+        _g_ring_overflow = true;
+    }
+}
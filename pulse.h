@@ -0,0 +1,53 @@
+//*****************************************************************************
+// Title        : Pulse contact capture and debouncing
+// Author       : agent
+// Created      : 2026-10-16
+//
+// Part of the pulse to tone (DTMF) converter.
+//
+// This code is distributed under the GNU Public License
+// which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+#ifndef __PULSE_H__
+#define __PULSE_H__
+
+// Dial pulse capture. INT0 fires on both edges of the pulse contact and
+// stores the time (timer_now()) and the new pin level in a small ring;
+// pulse_poll() then debounces the edges in main context:
+//
+//   MAKE --(open for PULSE_MIN_BREAK_MS)--> BREAK   (counts a pulse)
+//   BREAK --(closed for PULSE_MIN_MAKE_MS)--> MAKE
+//
+// Anything shorter is contact bounce and is ignored. The debounced edges
+// also give the rate and break/make ratio of the dial, which decide how
+// soon after returning to rest the digit is complete. pulse_poll() and
+// pulse_ready() set a timer deadline for the next time they need looking
+// at. Timer0 only runs while the CPU is awake or idle, so the caller must
+// not power down while pulse_active().
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define PIN_PULSE                   PB2     // INT0, high while the pulse contact is open (break)
+
+#define PULSE_RING_SIZE             8       // Edges, power of two
+#define PULSE_MIN_BREAK_MS          10
+#define PULSE_MIN_MAKE_MS           10
+#define PULSE_PPS_MIN               8       // Dial speeds that are measured,
+#define PULSE_PPS_MAX               12      // others settle for PULSE_SETTLE_MAX_MS
+#define PULSE_SETTLE_MAX_MS         72      // Make at 8 pps, 55/45, plus 1/8 period
+
+void pulse_start(void);
+void pulse_stop(void);
+bool pulse_active(void);
+void pulse_rest(void);
+bool pulse_ready(void);
+void pulse_poll(void);
+uint8_t pulse_count(void);
+bool pulse_lost(void);
+uint16_t pulse_period(void);
+uint16_t pulse_break(void);
+
+#endif /* __PULSE_H__ */
@@ -0,0 +1,172 @@
+//*****************************************************************************
+// Title        : Redial log in EEPROM
+// Author       : agent
+// Created      : 2026-10-16
+//
+// Part of the pulse to tone (DTMF) converter.
+//
+// This code is distributed under the GNU Public License
+// which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <avr/eeprom.h>
+#include <util/crc16.h>
+
+#include "redial.h"
+
+typedef struct
+{
+    uint8_t seq;                            // one more than the record before it
+    uint8_t digits[DIGITS_PACKED_SIZE];     // see digits.h
+    uint8_t crc;                            // CRC-8 (CCITT) of seq and digits
+} redial_record_t;
+
+static bool redial_read(uint8_t index, redial_record_t *record);
+static bool redial_is_prefix(const uint8_t *packed, const uint8_t *longer);
+static uint8_t redial_crc(const redial_record_t *record);
+
+// Erased (all 0xFF) records fail the CRC; all zero ones would not
+redial_record_t EEMEM _g_redial_log_eeprom[REDIAL_LOG_RECORDS] =
+{
+    [0 ... (REDIAL_LOG_RECORDS - 1)] = { 0xFF, { [0 ... (DIGITS_PACKED_SIZE - 1)] = DIGITS_PACKED_EMPTY }, 0xFF }
+};
+
+static int8_t _g_newest = -1;               // index of the newest record, -1 if none
+static uint8_t _g_newest_seq;
+
+// Find the newest record: the highest sequence number (modulo 256) with a
+// good CRC. Call once at start up; saves keep track of it after that
+void redial_init(void)
+{
+    redial_record_t record;
+
+    _g_newest = -1;
+
+    for (uint8_t i = 0; i < REDIAL_LOG_RECORDS; i++)
+    {
+        if (!redial_read(i, &record))
+            continue;
+
+        if (_g_newest < 0 || (int8_t)(record.seq - _g_newest_seq) > 0)
+        {
+            _g_newest = i;
+            _g_newest_seq = record.seq;
+        }
+    }
+}
+
+// Latest redial number, empty if nothing was ever saved
+void redial_load(uint8_t *packed)
+{
+    if (!redial_load_nth(0, packed))
+        memset(packed, DIGITS_PACKED_EMPTY, DIGITS_PACKED_SIZE);
+}
+
+// The n-th most recent number (0 is the redial number), walking back from
+// the newest record while the sequence numbers run on. A record a newer
+// one extends is the same call saved before the last few digits were
+// dialed and is skipped. Returns false, leaving packed alone, if the log
+// holds fewer numbers
+bool redial_load_nth(uint8_t n, uint8_t *packed)
+{
+    redial_record_t record;
+    uint8_t number[DIGITS_PACKED_SIZE];
+    int8_t index = _g_newest;
+    uint8_t seq = _g_newest_seq;
+
+    for (uint8_t i = 0; index >= 0 && i < REDIAL_LOG_RECORDS; i++)
+    {
+        if (!redial_read(index, &record) || record.seq != seq)
+            break;
+
+        if (i == 0 || !redial_is_prefix(record.digits, number))
+        {
+            memcpy(number, record.digits, DIGITS_PACKED_SIZE);
+
+            if (n-- == 0)
+            {
+                memcpy(packed, number, DIGITS_PACKED_SIZE);
+                return true;
+            }
+        }
+
+        index = index ? index - 1 : REDIAL_LOG_RECORDS - 1;
+        seq--;
+    }
+
+    return false;
+}
+
+// Append a new record after the newest one: one record written, whatever
+// the length of the log. Saving the number already stored writes nothing
+void redial_save(const uint8_t *packed)
+{
+    redial_record_t record;
+    uint8_t index = 0;
+
+    if (_g_newest >= 0)
+    {
+        if (redial_read(_g_newest, &record) && !memcmp(record.digits, packed, DIGITS_PACKED_SIZE))
+            return;
+
+        index = (_g_newest + 1) % REDIAL_LOG_RECORDS;
+        record.seq = _g_newest_seq + 1;
+    }
+    else
+    {
+        record.seq = 0;
+    }
+
+    memcpy(record.digits, packed, DIGITS_PACKED_SIZE);
+    record.crc = redial_crc(&record);
+
+    // Sequence number last: until it is written the slot still carries the
+    // oldest sequence number, so even a half written record that happens
+    // to pass the CRC can never be taken for the newest
+    eeprom_update_block(record.digits, _g_redial_log_eeprom[index].digits, DIGITS_PACKED_SIZE);
+    eeprom_update_byte(&_g_redial_log_eeprom[index].crc, record.crc);
+    eeprom_update_byte(&_g_redial_log_eeprom[index].seq, record.seq);
+
+    _g_newest = index;
+    _g_newest_seq = record.seq;
+}
+
+static bool redial_read(uint8_t index, redial_record_t *record)
+{
+    eeprom_read_block(record, &_g_redial_log_eeprom[index], sizeof(*record));
+
+    return record->crc == redial_crc(record);
+}
+
+// True if every digit of packed starts longer (equal numbers included)
+static bool redial_is_prefix(const uint8_t *packed, const uint8_t *longer)
+{
+    for (uint8_t i = 0; i < DIGITS_MAX; i++)
+    {
+        int8_t digit = digits_get(packed, i);
+
+        if (digit == DIGIT_OFF)
+            return true;
+
+        if (digit != digits_get(longer, i))
+            return false;
+    }
+
+    return true;
+}
+
+static uint8_t redial_crc(const redial_record_t *record)
+{
+    const uint8_t *p = (const uint8_t *)record;
+    uint8_t crc = 0;
+
+    for (uint8_t i = 0; i < offsetof(redial_record_t, crc); i++)
+        crc = _crc8_ccitt_update(crc, p[i]);
+
+    return crc;
+}
@@ -0,0 +1,36 @@
+//*****************************************************************************
+// Title        : Redial log in EEPROM
+// Author       : agent
+// Created      : 2026-10-16
+//
+// Part of the pulse to tone (DTMF) converter.
+//
+// This code is distributed under the GNU Public License
+// which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+#ifndef __REDIAL_H__
+#define __REDIAL_H__
+
+// Wear leveled redial memory. Every save appends a record (sequence number,
+// packed digits, CRC) to a ring of REDIAL_LOG_RECORDS in EEPROM instead of
+// rewriting one fixed block, so each cell is written once every
+// REDIAL_LOG_RECORDS calls. The newest record with a good CRC is the
+// redial number; a save cut short by a power loss fails its CRC and the
+// previous number is used. The older records double as a history of the
+// last numbers dialed (redial_load_nth).
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "digits.h"
+
+#define REDIAL_LOG_RECORDS          20      // 18 bytes each
+
+void redial_init(void);
+void redial_load(uint8_t *packed);
+bool redial_load_nth(uint8_t n, uint8_t *packed);
+void redial_save(const uint8_t *packed);
+
+#endif /* __REDIAL_H__ */
@@ -0,0 +1,214 @@
+//*****************************************************************************
+// Title        : Tickless time base and watchdog
+// Author       : agent
+// Created      : 2026-10-16
+//
+// Part of the pulse to tone (DTMF) converter.
+//
+// This code is distributed under the GNU Public License
+// which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include <avr/wdt.h>
+#include <util/atomic.h>
+
+#include "timer.h"
+
+#define TIMER_CLK_DIV1              _BV(CS00)
+#define TIMER_CLK_DIV1024           (_BV(CS02) | _BV(CS00))
+
+volatile uint16_t _g_timer_ticks;           // ticks since power up, free running
+static bool _g_slow;
+static volatile bool _g_deadline_hit;       // since the last timer_idle()
+
+// Start silent
+void timer_init(void)
+{
+    _g_timer_ticks = 0;
+    _g_slow = false;
+    timer_slow();
+}
+
+// Tone output: fast PWM at F_CPU/256, TIMER0_OVF_vect every tick
+void timer_fast(void)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        if (_g_slow)
+        {
+            _g_timer_ticks = timer_now();
+            _g_slow = false;
+
+            TCCR0B = TIMER_CLK_DIV1;
+            TCCR0A = _BV(WGM00) | _BV(WGM01);
+            TCNT0 = 0;
+            TIFR = _BV(TOV0);
+            TIMSK = _BV(TOIE0);
+        }
+    }
+}
+
+// Silence: normal mode at F_CPU/1024. Compare B at 0xFF counts the wraps
+// (its flag is set the timer clock after the match, as the count goes to
+// 0), compare A is free for timer_wake_at() (OCR0x aren't double buffered
+// in normal mode, so a new deadline applies straight away)
+void timer_slow(void)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        if (!_g_slow)
+        {
+            _g_slow = true;
+
+            TIMSK = 0;
+            TCCR0A = 0;
+            TCCR0B = TIMER_CLK_DIV1024;
+            TCNT0 = 0;
+            OCR0B = UINT8_MAX;
+            TIFR = _BV(OCF0A) | _BV(OCF0B) | _BV(TOV0);
+            TIMSK = _BV(OCIE0B);
+        }
+    }
+}
+
+// Current time in ticks. Safe from interrupts, INT0_vect timestamps with it
+uint16_t timer_now(void)
+{
+    uint16_t now;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        now = _g_timer_ticks;
+
+        if (_g_slow)
+        {
+            uint8_t count = TCNT0;
+
+            // Wrapped, but the compare B interrupt hasn't run yet. The
+            // flag is only ever pending for a count or two, so a high count
+            // was read before the wrap that set it
+            if ((TIFR & _BV(OCF0B)) && count < 128)
+                now += TIMER_SLOW_WRAP;
+
+            now += (uint16_t)count * TIMER_SLOW_TICKS;
+        }
+    }
+
+    return now;
+}
+
+// True once when is no longer in the future. Deadlines must be less
+// than half the 16 bit tick range (2s at 4MHz) away
+bool timer_passed(uint16_t when)
+{
+    return (int16_t)(timer_now() - when) >= 0;
+}
+
+// Wake the CPU from timer_idle() once when has passed, give or take
+// TIMER_SLOW_TICKS. One shot, and only needed while silent: an earlier
+// deadline already set is kept, one beyond the next wrap is left to the
+// wrap, and the caller sets it again after every wake up until it has
+// passed
+void timer_wake_at(uint16_t when)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        uint8_t count = TCNT0;
+        uint16_t left = when - timer_now();
+        uint16_t target;
+
+        if (!_g_slow)
+            return;
+
+        if ((int16_t)left <= 0)
+        {
+            _g_deadline_hit = true;
+            return;
+        }
+
+        // The flag is set as the count moves on from the target, so all
+        // of it has passed by then
+        target = count + (left + TIMER_SLOW_TICKS - 1) / TIMER_SLOW_TICKS;
+
+        if (target > UINT8_MAX)
+            return;
+
+        if ((TIMSK & _BV(OCIE0A)) && OCR0A > count && OCR0A <= target)
+            return;
+
+        OCR0A = target;
+        TIFR = _BV(OCF0A);
+        TIMSK |= _BV(OCIE0A);
+    }
+}
+
+// Idle sleep until the next interrupt, unless a deadline set since the
+// last call has been reached already (it may have fired on the way here)
+void timer_idle(void)
+{
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    cli();
+
+    if (!_g_deadline_hit)
+    {
+        sleep_enable();
+        sei();                          // takes effect after the next instruction,
+        sleep_cpu();                    // so a wake up can't slip in between
+        sleep_disable();
+    }
+
+    _g_deadline_hit = false;
+    sei();
+}
+
+// Watchdog interrupt (WDT_vect, in main.c) after the given delay and then
+// every delay until stopped. Runs in power down too
+void timer_wdt_start(uint8_t delay)
+{
+    wdt_reset();
+    cli();
+    MCUSR = 0x00;
+    WDTCR |= _BV(WDCE) | _BV(WDE);
+    switch (delay)
+    {
+        case WDT_64MS:
+            WDTCR = _BV(WDIE) | _BV(WDP1);
+            break;
+        case WDT_128MS:
+            WDTCR = _BV(WDIE) | _BV(WDP1) | _BV(WDP0);
+            break;
+        case WDT_2S:
+            WDTCR = _BV(WDIE) | _BV(WDP0) | _BV(WDP1) | _BV(WDP2); // 2048ms
+            break;
+    }
+    sei();
+}
+
+void timer_wdt_stop(void)
+{
+    wdt_reset();
+    cli();
+    MCUSR = 0x00;
+    WDTCR |= _BV(WDCE) | _BV(WDE);
+    WDTCR = 0x00;
+    sei();
+}
+
+// A deadline: nothing to do but wake up, and only once
+ISR(TIMER0_COMPA_vect)
+{
+    TIMSK &= ~_BV(OCIE0A);
+    _g_deadline_hit = true;
+}
+
+// Counter wrap while silent
+ISR(TIMER0_COMPB_vect)
+{
+    _g_timer_ticks += TIMER_SLOW_WRAP;
+}
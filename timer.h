@@ -0,0 +1,49 @@
+//*****************************************************************************
+// Title        : Tickless time base and watchdog
+// Author       : agent
+// Created      : 2026-10-16
+//
+// Part of the pulse to tone (DTMF) converter.
+//
+// This code is distributed under the GNU Public License
+// which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+#ifndef __TIMER_H__
+#define __TIMER_H__
+
+// Time base, one-shot deadlines and the watchdog.
+//
+// Time is counted in ticks of 256 CPU cycles, one PWM period (64us at
+// 4MHz), see T0_OVERFLOWS() in dtmf.h. While a tone plays Timer0 runs the
+// PWM and its overflow interrupt, which outputs every sample, also counts
+// the ticks. While silent Timer0 is slowed to F_CPU/1024 with the overflow
+// interrupt off: timer_idle() is then only woken by a deadline set with
+// timer_wake_at() or once per counter wrap (every TIMER_SLOW_WRAP ticks),
+// and times read in TIMER_SLOW_TICKS steps. Neither runs in power down;
+// that is what the watchdog is for.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define TIMER_SLOW_TICKS            4       // ticks per Timer0 count at F_CPU/1024
+#define TIMER_SLOW_WRAP             (256 * TIMER_SLOW_TICKS)
+
+#define WDT_64MS                    0x00
+#define WDT_128MS                   0x01
+#define WDT_2S                      0x02
+
+void timer_init(void);
+void timer_fast(void);
+void timer_slow(void);
+uint16_t timer_now(void);
+bool timer_passed(uint16_t when);
+void timer_wake_at(uint16_t when);
+void timer_idle(void);
+void timer_wdt_start(uint8_t delay);
+void timer_wdt_stop(void);
+
+extern volatile uint16_t _g_timer_ticks;
+
+#endif /* __TIMER_H__ */
@@ -0,0 +1,118 @@
+//*****************************************************************************
+// Title        : Event trace ring
+// Author       : agent
+// Created      : 2026-10-16
+//
+// Part of the pulse to tone (DTMF) converter.
+//
+// This code is distributed under the GNU Public License
+// which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <avr/io.h>
+#include <util/atomic.h>
+#include <util/delay_basic.h>
+
+#include "dtmf.h"
+#include "timer.h"
+#include "trace.h"
+
+#ifdef TRACE_RING
+
+// Cycles each bit takes on top of the delay loop, which takes 4 per count
+#define TRACE_BIT_CYCLES            12
+#define TRACE_BIT_LOOPS             ((F_CPU / TRACE_BAUD - TRACE_BIT_CYCLES + 2) / 4)
+
+#if F_CPU / TRACE_BAUD < 4 * TRACE_BIT_CYCLES
+#error "F_CPU too low for TRACE_BAUD"
+#endif
+
+static trace_entry_t _g_trace[TRACE_SIZE];
+static uint8_t _g_trace_head;               // next entry to write
+static uint8_t _g_trace_count;
+
+// Record an event. Safe from interrupts; once the ring is full the oldest
+// entry goes
+void trace(uint8_t event, uint8_t arg)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        trace_entry_t *entry = &_g_trace[_g_trace_head];
+
+        entry->time = timer_now();
+        entry->event = event;
+        entry->arg = arg;
+
+        _g_trace_head = (_g_trace_head + 1) & (TRACE_SIZE - 1);
+
+        if (_g_trace_count < TRACE_SIZE)
+            _g_trace_count++;
+    }
+}
+
+#ifdef TRACE_UART
+// One 8N1 byte on PB0. Interrupts are held off for the byte (about 1ms at
+// 9600 baud) to keep the bits even; Timer0 and the watchdog only lose
+// that much time
+static uint8_t trace_uart_byte(uint8_t byte, uint8_t check)
+{
+    uint16_t bits = ((uint16_t)byte << 1) | 0x200;     // start bit, 8 data bits LSB first, stop bit
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        for (uint8_t i = 0; i < 10; i++)
+        {
+            if (bits & 1)
+                PORTB |= _BV(PIN_PWM_OUT);
+            else
+                PORTB &= ~_BV(PIN_PWM_OUT);
+
+            bits >>= 1;
+            _delay_loop_2(TRACE_BIT_LOOPS);
+        }
+    }
+
+    return check ^ byte;
+}
+
+// Send the ring, see trace.h. Only call once dtmf_wait() has returned:
+// PB0 must be an idle output, it's left low as the PWM leaves it
+void trace_dump(void)
+{
+    uint8_t count = _g_trace_count;
+    uint8_t index = (_g_trace_head - count) & (TRACE_SIZE - 1);
+    uint8_t check = 0;
+
+    // Idle high for a byte first, so the receiver finds the start bit
+    PORTB |= _BV(PIN_PWM_OUT);
+
+    for (uint8_t i = 0; i < 10; i++)
+        _delay_loop_2(TRACE_BIT_LOOPS);
+
+    trace_uart_byte(TRACE_MAGIC[0], 0);
+    trace_uart_byte(TRACE_MAGIC[1], 0);
+    check = trace_uart_byte(count, check);
+    check = trace_uart_byte((uint8_t)(F_CPU / 256), check);
+    check = trace_uart_byte((uint8_t)((F_CPU / 256) >> 8), check);
+
+    // Events recorded meanwhile may overwrite ones not sent yet; the ring
+    // is only read, never locked
+    while (count--)
+    {
+        const trace_entry_t *entry = &_g_trace[index];
+
+        check = trace_uart_byte(entry->time, check);
+        check = trace_uart_byte(entry->time >> 8, check);
+        check = trace_uart_byte(entry->event, check);
+        check = trace_uart_byte(entry->arg, check);
+        index = (index + 1) & (TRACE_SIZE - 1);
+    }
+
+    trace_uart_byte(check, 0);
+    PORTB &= ~_BV(PIN_PWM_OUT);
+}
+#endif /* TRACE_UART */
+
+#endif /* TRACE_RING */
@@ -0,0 +1,83 @@
+//*****************************************************************************
+// Title        : Event trace ring
+// Author       : agent
+// Created      : 2026-10-16
+//
+// Part of the pulse to tone (DTMF) converter.
+//
+// This code is distributed under the GNU Public License
+// which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+// Event trace for chasing misdials. -DTRACE_RING keeps the last TRACE_SIZE
+// events in a ring in RAM: the time (timer_now() ticks), what happened and
+// a byte of detail. Without it TRACE() compiles to nothing.
+//
+// -DTRACE_UART (with -DTRACE_RING) adds L2-2 (hold the dial past the low
+// beep and the tune, then dial 2), which sends the ring out of PB0 as 8N1
+// serial at TRACE_BAUD, oldest event first. PB0 is the only pin free
+// once the tones have played out: PB3 and PB4 take the crystal and PB5 is
+// reset. Take the line off and clip a 3V serial adapter's RX to PB0 (on
+// the chip's side of the RC filter); host/tracedump turns the capture
+// into a timeline. Frame: TRACE_MAGIC, count, ticks per second (16 bit),
+// count entries of time (16 bit), event and detail, then the XOR of
+// everything after the magic. 16 bit values are little endian.
+
+#include <stdint.h>
+
+#ifndef TRACE_SIZE
+#define TRACE_SIZE                  32      // Events, power of two, 4 bytes each
+#endif
+
+#if TRACE_SIZE & (TRACE_SIZE - 1)
+#error "TRACE_SIZE must be a power of two"
+#endif
+
+#define TRACE_BAUD                  9600
+#define TRACE_MAGIC                 "TR"
+
+// Events, with the detail byte each one records
+#define TR_BOOT                     0x01    // Reset cause, MCUSR
+#define TR_EDGE                     0x02    // INT0_vect, pulse contact level
+#define TR_PULSE                    0x03    // Pulse counted after debouncing, count so far
+#define TR_DIAL                     0x04    // Dial contact changed, 1 at rest
+#define TR_DIGIT                    0x05    // Pulses counted once the digit was complete
+#define TR_STATE                    0x06    // Menu event << 4 | state it led to
+#define TR_WDT                      0x07    // Watchdog wake up
+#define TR_TONE                     0x08    // Sound started, its digit code (dtmf.h)
+#define TR_TONE_END                 0x09    // Tone output done, 1 if cut short
+#define TR_EEPROM                   0x0A    // EEPROM write, one of TR_EE_
+#define TR_COUNT                    0x0B
+
+#define TR_EE_SPEED_DIAL            0x00    // Through the journal
+#define TR_EE_REDIAL                0x01    // Redial log
+#define TR_EE_TIMING                0x02    // Playback timing of a position
+#define TR_EE_RECOVER               0x03    // Journal replayed at start up
+
+#define TR_PULSE_LOST               0xFF    // TR_PULSE detail: INT0 dropped edges, digit void
+
+typedef struct
+{
+    uint16_t time;
+    uint8_t event;
+    uint8_t arg;
+} trace_entry_t;
+
+#ifdef TRACE_RING
+void trace(uint8_t event, uint8_t arg);
+#define TRACE(event, arg)           trace((event), (arg))
+#else
+#define TRACE(event, arg)           ((void)0)
+#endif
+
+#if defined(TRACE_RING) && defined(TRACE_UART)
+void trace_dump(void);
+#else
+#define trace_dump()                ((void)0)
+#endif
+
+#endif /* __TRACE_H__ */